@@ -146,8 +146,12 @@ public:
 
     virtual void RequestUpdate(ActionContext* context) override
     {
-        if(context->GetTrack())
-            context->UpdateWidgetValue(GetCurrentNormalizedValue(context));
+        if(MediaTrack* track = context->GetTrack())
+        {
+            double vol, pan = 0.0;
+            DAW::GetTrackUIVolPan(track, &vol, &pan);
+            context->UpdateWidgetVolume(vol);
+        }
         else
             context->ClearWidget();
     }
@@ -707,8 +711,13 @@ public:
     
     virtual void RequestUpdate(ActionContext* context) override
     {
-        if(context->GetTrack())
-            context->UpdateWidgetValue(GetCurrentNormalizedValue(context));
+        if(MediaTrack* track = context->GetTrack())
+        {
+            int numHardwareSends = DAW::GetTrackNumSends(track, 1);
+            double vol, pan = 0.0;
+            DAW::GetTrackSendUIVolPan(track, context->GetSlotIndex() + numHardwareSends, &vol, &pan);
+            context->UpdateWidgetVolume(vol);
+        }
         else
             context->ClearWidget();
     }
@@ -752,7 +761,7 @@ public:
             int numHardwareSends = DAW::GetTrackNumSends(track, 1);
             double vol, pan = 0.0;
             DAW::GetTrackSendUIVolPan(track, context->GetParamIndex() + numHardwareSends, &vol, &pan);
-            context->UpdateWidgetValue(VAL2DB(vol));
+            context->UpdateWidgetVolumeDB(vol);
         }
         else
             context->ClearWidget();
@@ -1015,7 +1024,7 @@ public:
         if(MediaTrack* track = context->GetTrack())
         {
             if(GetCurrentNormalizedValue(context) == 0)
-                context->UpdateWidgetValue(0);
+                context->UpdateWidgetValue(0.0);
             else
                 context->UpdateWidgetValue(1);
         }
@@ -1062,8 +1071,12 @@ public:
     
     virtual void RequestUpdate(ActionContext* context) override
     {
-        if(context->GetTrack())
-            context->UpdateWidgetValue(GetCurrentNormalizedValue(context));
+        if(MediaTrack* track = context->GetTrack())
+        {
+            double vol, pan = 0.0;
+            DAW::GetTrackReceiveUIVolPan(track, context->GetSlotIndex(), &vol, &pan);
+            context->UpdateWidgetVolume(vol);
+        }
         else
             context->ClearWidget();
     }
@@ -1102,7 +1115,7 @@ public:
         {
             double vol, pan = 0.0;
             DAW::GetTrackReceiveUIVolPan(track, context->GetParamIndex(), &vol, &pan);
-            context->UpdateWidgetValue(VAL2DB(vol));
+            context->UpdateWidgetVolumeDB(vol);
         }
         else
             context->ClearWidget();
@@ -1316,7 +1329,7 @@ public:
         if(MediaTrack* track = context->GetTrack())
         {
             if(GetCurrentNormalizedValue(context) == 0)
-                context->UpdateWidgetValue(0);
+                context->UpdateWidgetValue(0.0);
             else
                 context->UpdateWidgetValue(1);
         }
@@ -1369,7 +1382,7 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            string name = "NoMap";
+            const char* name = "NoMap";
             
             if(context->GetSlotIndex() >= DAW::TrackFX_GetCount(track))
                 name= "";
@@ -1380,7 +1393,7 @@ public:
                 DAW::TrackFX_GetFXName(track, context->GetSlotIndex(), fxName, sizeof(fxName));
                 
                 if(Zone* zone = context->GetSurface()->GetZone(fxName))
-                    name = zone->GetNameOrAlias();
+                    name = zone->GetNameOrAlias().c_str();
             }
             
             context->UpdateWidgetValue(name);
@@ -1400,7 +1413,10 @@ public:
     virtual void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(context->GetFxParamDisplayName());
+        {
+            char fxParamName[BUFSZ];
+            context->UpdateWidgetValue(context->GetFxParamDisplayName(fxParamName, sizeof(fxParamName)));
+        }
         else
             context->ClearWidget();
     }
@@ -1419,7 +1435,7 @@ public:
         {
             char fxParamValue[128];
             DAW::TrackFX_GetFormattedParamValue(track, context->GetSlotIndex(), context->GetParamIndex(), fxParamValue, sizeof(fxParamValue));
-            context->UpdateWidgetValue(string(fxParamValue));
+            context->UpdateWidgetValue(fxParamValue);
         }
         else
             context->ClearWidget();
@@ -1445,7 +1461,7 @@ public:
             {
                 char fxParamName[128];
                 DAW::TrackFX_GetParamName(track, fxSlotNum, fxParamNum, fxParamName, sizeof(fxParamName));
-                context->UpdateWidgetValue(string(fxParamName));
+                context->UpdateWidgetValue(fxParamName);
             }
         }
         else
@@ -1472,7 +1488,7 @@ public:
             {
                 char fxParamValue[128];
                 DAW::TrackFX_GetFormattedParamValue(track, fxSlotNum, fxParamNum, fxParamValue, sizeof(fxParamValue));
-                context->UpdateWidgetValue(string(fxParamValue));
+                context->UpdateWidgetValue(fxParamValue);
             }
         }
         else
@@ -1491,10 +1507,10 @@ public:
     {
         if(MediaTrack* track = context->GetTrack())
         {
-            string sendTrackName = "";
+            const char* sendTrackName = "";
             MediaTrack* destTrack = (MediaTrack *)DAW::GetSetTrackSendInfo(track, 0, context->GetSlotIndex() + DAW::GetTrackNumSends(track, 1), "P_DESTTRACK", 0);;
             if(destTrack)
-                sendTrackName = (char *)DAW::GetSetMediaTrackInfo(destTrack, "P_NAME", NULL);
+                sendTrackName = (const char *)DAW::GetSetMediaTrackInfo(destTrack, "P_NAME", NULL);
             context->UpdateWidgetValue(sendTrackName);
         }
         else
@@ -1520,9 +1536,7 @@ public:
                 double vol, pan = 0.0;
                 DAW::GetTrackSendUIVolPan(track, context->GetSlotIndex() + numHardwareSends, &vol, &pan);
 
-                char trackVolume[128];
-                snprintf(trackVolume, sizeof(trackVolume), "%7.2lf", VAL2DB(vol));
-                context->UpdateWidgetValue(string(trackVolume));
+                context->UpdateWidgetVolumeText(vol);
             }
             else
                 context->ClearWidget();
@@ -1548,7 +1562,7 @@ public:
             {
                 double panVal = DAW::GetTrackSendInfo_Value(track, 0, context->GetSlotIndex() + DAW::GetTrackNumSends(track, 1), "D_PAN");
                 
-                context->UpdateWidgetValue(context->GetPanValueString(panVal));
+                context->UpdateWidgetPanText(panVal);
             }
             else
                 context->ClearWidget();
@@ -1576,7 +1590,7 @@ public:
                 
                 double prePostVal = DAW::GetTrackSendInfo_Value(track, 0, context->GetSlotIndex() + DAW::GetTrackNumSends(track, 1), "I_SENDMODE");
                 
-                string prePostValueString = "";
+                const char* prePostValueString = "";
                 
                 if(prePostVal == 0)
                     prePostValueString = "PostFader";
@@ -1609,8 +1623,8 @@ public:
             MediaTrack* srcTrack = (MediaTrack *)DAW::GetSetTrackSendInfo(track, -1, context->GetSlotIndex(), "P_SRCTRACK", 0);
             if(srcTrack)
             {
-                string receiveTrackName = "";
-                receiveTrackName = (char *)DAW::GetSetMediaTrackInfo(srcTrack, "P_NAME", NULL);
+                const char* receiveTrackName = "";
+                receiveTrackName = (const char *)DAW::GetSetMediaTrackInfo(srcTrack, "P_NAME", NULL);
                 context->UpdateWidgetValue(receiveTrackName);
             }
             else
@@ -1635,9 +1649,7 @@ public:
             MediaTrack* srcTrack = (MediaTrack *)DAW::GetSetTrackSendInfo(track, -1, context->GetSlotIndex(), "P_SRCTRACK", 0);
             if(srcTrack)
             {
-                char trackVolume[128];
-                snprintf(trackVolume, sizeof(trackVolume), "%7.2lf", VAL2DB(DAW::GetTrackSendInfo_Value(track, -1, context->GetSlotIndex(), "D_VOL")));
-                context->UpdateWidgetValue(string(trackVolume));
+                context->UpdateWidgetVolumeText(DAW::GetTrackSendInfo_Value(track, -1, context->GetSlotIndex(), "D_VOL"));
             }
             else
                 context->ClearWidget();
@@ -1663,7 +1675,7 @@ public:
             {
                 double panVal = DAW::GetTrackSendInfo_Value(track, -1, context->GetSlotIndex(), "D_PAN");
                 
-                context->UpdateWidgetValue(context->GetPanValueString(panVal));
+                context->UpdateWidgetPanText(panVal);
             }
             else
                 context->ClearWidget();
@@ -1691,7 +1703,7 @@ public:
                 
                 double prePostVal = DAW::GetTrackSendInfo_Value(track, -1, context->GetSlotIndex(), "I_SENDMODE");
                 
-                string prePostValueString = "";
+                const char* prePostValueString = "";
                 
                 if(prePostVal == 0)
                     prePostValueString = "PostFader";
@@ -1732,7 +1744,7 @@ public:
 
     virtual void RequestUpdate(ActionContext* context) override
     {
-        context->UpdateWidgetValue(0);
+        context->UpdateWidgetValue(0.0);
     }
 };
 
@@ -1761,7 +1773,7 @@ public:
                 DAW::GetTrackName(track, buf, sizeof(buf));
             }
             
-            context->UpdateWidgetValue(string(buf));
+            context->UpdateWidgetValue(buf);
         }
         else
             context->ClearWidget();
@@ -1781,10 +1793,7 @@ public:
         {
             double vol, pan = 0.0;
             DAW::GetTrackUIVolPan(track, &vol, &pan);
-
-            char trackVolume[128];
-            snprintf(trackVolume, sizeof(trackVolume), "%7.2lf", VAL2DB(vol));
-            context->UpdateWidgetValue(string(trackVolume));
+            context->UpdateWidgetVolumeText(vol);
         }
         else
             context->ClearWidget();
@@ -1805,7 +1814,7 @@ public:
             double vol, pan = 0.0;
             DAW::GetTrackUIVolPan(track, &vol, &pan);
 
-            context->UpdateWidgetValue(context->GetPanValueString(pan));
+            context->UpdateWidgetPanText(pan);
         }
         else
             context->ClearWidget();
@@ -1825,7 +1834,7 @@ public:
         {
             double widthVal = DAW::GetMediaTrackInfo_Value(track, "D_WIDTH");
             
-            context->UpdateWidgetValue(context->GetPanWidthValueString(widthVal));
+            context->UpdateWidgetPanWidthText(widthVal);
         }
         else
             context->ClearWidget();
@@ -1845,7 +1854,7 @@ public:
         {
             double panVal = DAW::GetMediaTrackInfo_Value(track, "D_DUALPANL");
             
-            context->UpdateWidgetValue(context->GetPanValueString(panVal));
+            context->UpdateWidgetPanText(panVal);
         }
         else
             context->ClearWidget();
@@ -1865,7 +1874,7 @@ public:
         {
             double panVal = DAW::GetMediaTrackInfo_Value(track, "D_DUALPANR");
             
-            context->UpdateWidgetValue(context->GetPanValueString(panVal));
+            context->UpdateWidgetPanText(panVal);
         }
         else
             context->ClearWidget();
@@ -1887,7 +1896,7 @@ public:
             {
                 double widthVal = DAW::GetMediaTrackInfo_Value(track, "D_WIDTH");
 
-                context->UpdateWidgetValue(context->GetPanWidthValueString(widthVal));
+                context->UpdateWidgetPanWidthText(widthVal);
             }
             else
             {
@@ -1903,7 +1912,7 @@ public:
                         panVal = DAW::GetMediaTrackInfo_Value(track, "D_DUALPANR");
                 }
                 
-                context->UpdateWidgetValue(context->GetPanValueString(panVal));
+                context->UpdateWidgetPanText(panVal);
             }
         }
         else
@@ -2449,7 +2458,7 @@ public:
 
     virtual void RequestUpdate(ActionContext* context) override
     {
-        context->UpdateWidgetValue(0);
+        context->UpdateWidgetValue(0.0);
     }
 };
 
@@ -2501,7 +2510,7 @@ public:
     virtual void RequestUpdate(ActionContext* context) override
     {
         if(MediaTrack* track = context->GetTrack())
-            context->UpdateWidgetValue(volToNormalized(DAW::Track_GetPeakInfo(track, context->GetIntParam())));
+            context->UpdateWidgetVolume(DAW::Track_GetPeakInfo(track, context->GetIntParam()));
         else
             context->ClearWidget();
     }
@@ -2520,7 +2529,7 @@ public:
         {
             double lrVol = (DAW::Track_GetPeakInfo(track, 0) + DAW::Track_GetPeakInfo(track, 1)) / 2.0;
             
-            context->UpdateWidgetValue(volToNormalized(lrVol));
+            context->UpdateWidgetVolume(lrVol);
         }
         else
             context->ClearWidget();
@@ -2543,7 +2552,7 @@ public:
             
             double lrVol =  lVol > rVol ? lVol : rVol;
             
-            context->UpdateWidgetValue(volToNormalized(lrVol));
+            context->UpdateWidgetVolume(lrVol);
         }
         else
             context->ClearWidget();
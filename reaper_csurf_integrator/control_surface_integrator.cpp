@@ -24,6 +24,19 @@ string GetLineEnding()
 #endif
 }
 
+// Options that don't belong to a single surface live in the [CSI] section of reaper.ini
+static int GetCSIOptionValue(const char* key)
+{
+    char buf[64];
+    DAW::GetPrivateProfileString("CSI", key, "0", buf, sizeof(buf), DAW::get_ini_file());
+    return atoi(buf);
+}
+
+static bool GetCSIOption(const char* key)
+{
+    return GetCSIOptionValue(key) != 0;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 struct MidiInputPort
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -31,6 +44,12 @@ struct MidiInputPort
     int port_ = 0;
     midi_Input* midiInput_ = nullptr;
     
+    // Optional input thread, fans the device's events out to one queue per surface on this port
+    thread inputThread_;
+    atomic<bool> shouldRun_ { false };
+    WDL_Mutex queuesMutex_;
+    vector<MidiInputQueue*> queues_;
+    
     MidiInputPort(int port, midi_Input* midiInput) : port_(port), midiInput_(midiInput) {}
 };
 
@@ -40,6 +59,17 @@ struct MidiOutputPort
 {
     int port_ = 0;
     midi_Output* midiOutput_ = nullptr;
+    MidiDeviceState deviceState_;
+    PortStats stats_;
+    
+    // Optional output thread, the only caller of the driver once it runs so a slow interface can't hold up Run
+    thread outputThread_;
+    atomic<bool> shouldRun_ { false };
+    MidiOutputQueue* queue_ = nullptr;
+    atomic<int> bytesPerSecond_ { 0 }; // 0 means unpaced
+    atomic<int> numReplaced_ { 0 };
+    atomic<int> numWaiting_ { 0 };
+    atomic<int> numDropped_ { 0 }; // by the scheduler, when a priority has too many waiting
     
     MidiOutputPort(int port, midi_Output* midiOutput) : port_(port), midiOutput_(midiOutput) {}
 };
@@ -55,150 +85,1841 @@ static midi_Input* GetMidiInputForPort(int inputPort)
     if(midiInputs_.count(inputPort) > 0)
         return midiInputs_[inputPort]->midiInput_; // return existing
     
-    // otherwise make new
-    midi_Input* newInput = DAW::CreateMIDIInput(inputPort);
+    // otherwise make new
+    midi_Input* newInput = DAW::CreateMIDIInput(inputPort);
+    
+    if(newInput)
+    {
+        newInput->start();
+        midiInputs_[inputPort] = new MidiInputPort(inputPort, newInput);
+        return newInput;
+    }
+    
+    return nullptr;
+}
+
+static void MidiInputThreadProc(MidiInputPort* inputPort)
+{
+    // The read buffer covers the time since the previous swap, frame_offset is in 1/1024000 sec from its start
+    double bufferStart = DAW::GetPreciseNumberOfMilliseconds();
+    
+    while(inputPort->shouldRun_)
+    {
+        DAW::SwapBufsPrecise(inputPort->midiInput_);
+        double bufferEnd = DAW::GetPreciseNumberOfMilliseconds();
+        
+        if(MIDI_eventlist* list = inputPort->midiInput_->GetReadBuf())
+        {
+            int bpos = 0;
+            MIDI_event_t* evt;
+            
+            inputPort->queuesMutex_.Enter();
+            
+            while ((evt = list->EnumItems(&bpos)))
+            {
+                if(evt->size < 0 || evt->size > MidiInputMaxMessageSize)
+                {
+                    for(auto queue : inputPort->queues_)
+                        queue->AddDropped();
+                    
+                    continue;
+                }
+                
+                TimestampedMidiEvent timestampedEvent;
+                timestampedEvent.timestamp = min(bufferStart + max(evt->frame_offset, 0) / 1024.0, bufferEnd);
+                timestampedEvent.event = MIDI_event_ex_t(evt->midi_message[0], evt->midi_message[1], evt->midi_message[2]);
+                
+                if(evt->size > 3)
+                    memcpy(timestampedEvent.event.midi_message, evt->midi_message, evt->size);
+                
+                timestampedEvent.event.size = evt->size;
+                
+                for(auto queue : inputPort->queues_)
+                    queue->Push(timestampedEvent);
+            }
+            
+            inputPort->queuesMutex_.Leave();
+        }
+        
+        bufferStart = bufferEnd;
+        
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+}
+
+static MidiInputQueue* GetMidiInputQueueForPort(int inputPort)
+{
+    if(midiInputs_.count(inputPort) == 0 || ! GetCSIOption("MidiInputThread"))
+        return nullptr;
+    
+    MidiInputPort* port = midiInputs_[inputPort];
+    MidiInputQueue* queue = new MidiInputQueue();
+    
+    port->queuesMutex_.Enter();
+    port->queues_.push_back(queue);
+    port->queuesMutex_.Leave();
+    
+    if(! port->shouldRun_)
+    {
+        port->shouldRun_ = true;
+        port->inputThread_ = thread(MidiInputThreadProc, port);
+    }
+    
+    return queue;
+}
+
+static void ReleaseMidiInputQueue(MidiInputQueue* queue)
+{
+    for(auto [index, input] : midiInputs_)
+    {
+        input->queuesMutex_.Enter();
+        input->queues_.erase(remove(input->queues_.begin(), input->queues_.end(), queue), input->queues_.end());
+        input->queuesMutex_.Leave();
+    }
+    
+    delete queue;
+}
+
+static midi_Output* GetMidiOutputForPort(int outputPort)
+{
+    if(midiOutputs_.count(outputPort) > 0)
+        return midiOutputs_[outputPort]->midiOutput_; // return existing
+    
+    // otherwise make new
+    midi_Output* newOutput = DAW::CreateMIDIOutput(outputPort, false, NULL);
+    
+    if(newOutput)
+    {
+        midiOutputs_[outputPort] = new MidiOutputPort(outputPort, newOutput);
+        return newOutput;
+    }
+    
+    return nullptr;
+}
+
+static void SendMidiOutputMessage(midi_Output* midiOutput, const MidiOutputMessage &message)
+{
+    if(message.size == 3 && message.bytes[0] != 0xf0)
+        midiOutput->Send(message.bytes[0], message.bytes[1], message.bytes[2], -1);
+    else
+    {
+        struct
+        {
+            MIDI_event_ex_t evt;
+            char data[MidiOutputMaxMessageSize];
+        } midiSysExData;
+        
+        midiSysExData.evt.frame_offset = 0;
+        midiSysExData.evt.size = message.size;
+        memcpy(midiSysExData.evt.midi_message, message.bytes, message.size);
+        midiOutput->SendMsg(&midiSysExData.evt, -1);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class MidiOutputScheduler // owned by a port's output thread, holds back what doesn't fit the port's byte budget
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    list<MidiOutputMessage> waiting_[NumMidiOutputPriorities];
+    map<pair<const void*, int>, list<MidiOutputMessage>::iterator> waitingByAddress_;
+    int numWaiting_ = 0;
+    int numDropped_ = 0;
+    double allowance_ = 0.0; // bytes, goes negative after a message bigger than what was left
+    double lastTime_ = 0.0;
+    
+    // Channel pressure meters and pitch bend faders carry their value in the second byte,
+    // and a processor's sysex always goes to the same display cell or pad
+    static int GetAddress(const MidiOutputMessage &message)
+    {
+        int status = message.bytes[0];
+        
+        if(status == 0xf0 || (status & 0xf0) == 0xd0 || (status & 0xf0) == 0xe0)
+            return status << 8;
+        else
+            return (status << 8) | message.bytes[1];
+    }
+    
+    void PopFront(list<MidiOutputMessage> &waiting)
+    {
+        const MidiOutputMessage &message = waiting.front();
+        
+        if(message.source != nullptr)
+            waitingByAddress_.erase(pair<const void*, int>(message.source, GetAddress(message)));
+        
+        waiting.pop_front();
+        numWaiting_--;
+    }
+    
+public:
+    int GetNumWaiting() { return numWaiting_; }
+    int GetNumDropped() { return numDropped_; }
+    
+    // Returns true when it replaced a message that was still waiting
+    bool Add(const MidiOutputMessage &message)
+    {
+        list<MidiOutputMessage> &waiting = waiting_[message.priority];
+        
+        pair<const void*, int> address(message.source, GetAddress(message));
+        
+        bool isReplacing = false;
+        
+        if(message.source != nullptr)
+        {
+            auto it = waitingByAddress_.find(address);
+            
+            if(it != waitingByAddress_.end())
+            {
+                if(it->second->priority == message.priority)
+                {
+                    *it->second = message; // keeps its place in line
+                    return true;
+                }
+                
+                // A new priority means a new line, the old message leaves its own
+                waiting_[it->second->priority].erase(it->second);
+                waitingByAddress_.erase(it);
+                numWaiting_--;
+                isReplacing = true;
+            }
+        }
+        
+        if(waiting.size() >= MidiOutputMaxWaitingPerPriority)
+        {
+            PopFront(waiting);
+            numDropped_++;
+        }
+        
+        waiting.push_back(message);
+        numWaiting_++;
+        
+        if(message.source != nullptr)
+            waitingByAddress_[address] = prev(waiting.end());
+        
+        return isReplacing;
+    }
+    
+    bool GetNext(MidiOutputMessage &message, double bytesPerSecond, double now, bool ignoreBudget)
+    {
+        if(lastTime_ == 0.0)
+            lastTime_ = now;
+        
+        allowance_ += (now - lastTime_) * bytesPerSecond / 1000.0;
+        lastTime_ = now;
+        
+        double maxAllowance = bytesPerSecond / 50.0; // 20ms worth, so an idle port can't save up a burst
+        
+        if(allowance_ > maxAllowance)
+            allowance_ = maxAllowance;
+        
+        if(allowance_ <= 0.0 && ! ignoreBudget)
+            return false;
+        
+        for(int priority = 0; priority < NumMidiOutputPriorities; priority++)
+        {
+            list<MidiOutputMessage> &waiting = waiting_[priority];
+            
+            if(waiting.size() == 0)
+                continue;
+            
+            message = waiting.front();
+            PopFront(waiting);
+            allowance_ -= message.size;
+            
+            return true;
+        }
+        
+        return false;
+    }
+};
+
+static void MidiOutputThreadProc(MidiOutputPort* outputPort)
+{
+    MidiOutputScheduler scheduler;
+    MidiOutputMessage message;
+    
+    while(true)
+    {
+        bool shouldRun = outputPort->shouldRun_; // read before draining, so whatever was queued ahead of a stop still goes out
+        int bytesPerSecond = outputPort->bytesPerSecond_;
+        
+        if(bytesPerSecond <= 0 && scheduler.GetNumWaiting() == 0)
+        {
+            while(outputPort->queue_->Pop(message))
+                SendMidiOutputMessage(outputPort->midiOutput_, message);
+        }
+        else
+        {
+            int numDropped = scheduler.GetNumDropped();
+            
+            while(outputPort->queue_->Pop(message))
+                if(scheduler.Add(message))
+                    outputPort->numReplaced_++;
+            
+            double now = DAW::GetPreciseNumberOfMilliseconds();
+            
+            while(scheduler.GetNext(message, bytesPerSecond, now, bytesPerSecond <= 0 || ! shouldRun))
+                SendMidiOutputMessage(outputPort->midiOutput_, message);
+            
+            outputPort->numWaiting_ = scheduler.GetNumWaiting();
+            outputPort->numDropped_ += scheduler.GetNumDropped() - numDropped;
+        }
+        
+        if( ! shouldRun)
+            return;
+        
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+}
+
+// [CSI] MidiOutputBytesPerSecond paces every port, MidiOutputBytesPerSecond<port> overrides it for one, DIN manages about 3000
+static int GetMidiOutputBytesPerSecond(int outputPort)
+{
+    int bytesPerSecond = GetCSIOptionValue(("MidiOutputBytesPerSecond" + to_string(outputPort)).c_str());
+    
+    return bytesPerSecond > 0 ? bytesPerSecond : GetCSIOptionValue("MidiOutputBytesPerSecond");
+}
+
+static bool GetIsMidiOutputThreaded(int outputPort)
+{
+    return GetMidiOutputBytesPerSecond(outputPort) > 0 || GetCSIOption("MidiOutputThread"); // pacing needs the thread
+}
+
+static MidiOutputQueue* GetMidiOutputQueueForPort(int outputPort)
+{
+    if(midiOutputs_.count(outputPort) == 0 || ! GetIsMidiOutputThreaded(outputPort))
+        return nullptr;
+    
+    MidiOutputPort* port = midiOutputs_[outputPort];
+    port->bytesPerSecond_ = GetMidiOutputBytesPerSecond(outputPort);
+    
+    if(! port->shouldRun_)
+    {
+        if(port->queue_ == nullptr)
+            port->queue_ = new MidiOutputQueue();
+        
+        port->shouldRun_ = true;
+        port->outputThread_ = thread(MidiOutputThreadProc, port);
+    }
+    
+    return port->queue_;
+}
+
+static void StopMidiOutputThread(MidiOutputPort* port)
+{
+    if(port->shouldRun_)
+    {
+        port->shouldRun_ = false;
+        port->outputThread_.join();
+    }
+}
+
+// Surfaces sharing a port all push from the main thread, so the queue keeps a single producer
+static bool PushMidiOutputMessage(MidiOutputQueue* queue, const unsigned char* bytes, int size, const void* source, int priority)
+{
+    if(size > MidiOutputMaxMessageSize)
+    {
+        queue->AddDropped();
+        return false;
+    }
+    
+    MidiOutputMessage message;
+    message.priority = priority;
+    message.source = source;
+    message.size = size;
+    memcpy(message.bytes, bytes, size);
+    
+    return queue->Push(message);
+}
+
+static MidiDeviceState* GetMidiDeviceStateForPort(int outputPort)
+{
+    if(midiOutputs_.count(outputPort) > 0)
+        return &midiOutputs_[outputPort]->deviceState_;
+    
+    return nullptr;
+}
+
+static PortStats* GetMidiOutputStatsForPort(int outputPort)
+{
+    if(midiOutputs_.count(outputPort) > 0)
+        return &midiOutputs_[outputPort]->stats_;
+    
+    return nullptr;
+}
+
+void ShutdownMidiIO()
+{
+    for(auto [index, input] : midiInputs_)
+    {
+        if(input->shouldRun_)
+        {
+            input->shouldRun_ = false;
+            input->inputThread_.join();
+        }
+        
+        input->midiInput_->stop();
+    }
+    
+    for(auto [index, output] : midiOutputs_)
+        StopMidiOutputThread(output);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OSC I/O Manager
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static map<string, oscpkt::UdpSocket*> inputSockets_;
+static map<string, oscpkt::UdpSocket*> outputSockets_;
+static map<string, PortStats> outputSocketStats_;
+
+// Sockets are keyed by everything they were opened with, so a reset that changes a port gets a fresh one
+static string GetInputSocketKey(const string &surfaceName, int inputPort)
+{
+    return surfaceName + ":" + to_string(inputPort);
+}
+
+static string GetOutputSocketKey(const string &surfaceName, const string &address, int outputPort)
+{
+    return surfaceName + ":" + address + ":" + to_string(outputPort);
+}
+
+static oscpkt::UdpSocket* GetInputSocketForPort(string surfaceName, int inputPort)
+{
+    string key = GetInputSocketKey(surfaceName, inputPort);
+    
+    if(inputSockets_.count(key) > 0)
+        return inputSockets_[key]; // return existing
+    
+    // otherwise make new
+    oscpkt::UdpSocket* newInputSocket = new oscpkt::UdpSocket();
+    
+    if(newInputSocket)
+    {
+        newInputSocket->bindTo(inputPort);
+        
+        if (! newInputSocket->isOk())
+        {
+            //cerr << "Error opening port " << PORT_NUM << ": " << inSocket_.errorMessage() << "\n";
+            delete newInputSocket;
+            return nullptr;
+        }
+        
+        inputSockets_[key] = newInputSocket;
+        
+        return inputSockets_[key];
+    }
+    
+    return nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct OSCInputThread
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    oscpkt::UdpSocket* inSocket_ = nullptr;
+    OSCInputQueue* queue_ = nullptr;
+    thread inputThread_;
+    atomic<bool> shouldRun_ { false };
+    
+    OSCInputThread(oscpkt::UdpSocket* inSocket) : inSocket_(inSocket), queue_(new OSCInputQueue()) {}
+};
+
+static map<string, OSCInputThread*> oscInputThreads_;
+
+static void OSCInputThreadProc(OSCInputThread* inputThread)
+{
+    oscpkt::PacketReader packetReader;
+    
+    while(inputThread->shouldRun_)
+    {
+        if( ! inputThread->inSocket_->isOk())
+        {
+            this_thread::sleep_for(chrono::milliseconds(100));
+            continue;
+        }
+        
+        if( ! inputThread->inSocket_->receiveNextPacket(10)) // select() with a timeout, so shutdown gets noticed
+            continue;
+        
+        double timestamp = DAW::GetPreciseNumberOfMilliseconds();
+        
+        packetReader.init(inputThread->inSocket_->packetData(), inputThread->inSocket_->packetSize());
+        oscpkt::Message *message;
+        
+        while (packetReader.isOk() && (message = packetReader.popMessage()) != 0)
+        {
+            OSCInputMessage inputMessage;
+            
+            if( ! message->arg().isFloat())
+                continue;
+            
+            if(message->addressPattern().length() >= sizeof(inputMessage.address))
+            {
+                inputThread->queue_->AddDropped();
+                continue;
+            }
+            
+            inputMessage.timestamp = timestamp;
+            message->arg().popFloat(inputMessage.value);
+            strcpy(inputMessage.address, message->addressPattern().c_str());
+            
+            inputThread->queue_->Push(inputMessage);
+        }
+    }
+}
+
+static OSCInputQueue* GetOSCInputQueueForSurface(string surfaceName, int inputPort)
+{
+    string key = GetInputSocketKey(surfaceName, inputPort);
+    
+    if(oscInputThreads_.count(key) > 0)
+        return oscInputThreads_[key]->queue_; // return existing
+    
+    if(inputSockets_.count(key) == 0 || ! GetCSIOption("OSCInputThread"))
+        return nullptr;
+    
+    OSCInputThread* inputThread = new OSCInputThread(inputSockets_[key]);
+    oscInputThreads_[key] = inputThread;
+    
+    inputThread->shouldRun_ = true;
+    inputThread->inputThread_ = thread(OSCInputThreadProc, inputThread);
+    
+    return inputThread->queue_;
+}
+
+void ShutdownOSCIO()
+{
+    for(auto [surfaceName, inputThread] : oscInputThreads_)
+    {
+        inputThread->shouldRun_ = false;
+        inputThread->inputThread_.join();
+    }
+}
+
+static oscpkt::UdpSocket* GetOutputSocketForAddressAndPort(string surfaceName, string address, int outputPort)
+{
+    string key = GetOutputSocketKey(surfaceName, address, outputPort);
+    
+    if(outputSockets_.count(key) > 0)
+        return outputSockets_[key]; // return existing
+    
+    // otherwise make new
+    oscpkt::UdpSocket* newOutputSocket = new oscpkt::UdpSocket();
+    
+    if(newOutputSocket)
+    {
+        if( ! newOutputSocket->connectTo(address, outputPort))
+        {
+            //cerr << "Error connecting " << remoteDeviceIP_ << ": " << outSocket_.errorMessage() << "\n";
+            delete newOutputSocket;
+            return nullptr;
+        }
+        
+        newOutputSocket->bindTo(outputPort);
+        
+        if ( ! newOutputSocket->isOk())
+        {
+            //cerr << "Error opening port " << outPort_ << ": " << outSocket_.errorMessage() << "\n";
+            delete newOutputSocket;
+            return nullptr;
+        }
+
+        outputSockets_[key] = newOutputSocket;
+        outputSocketStats_[key] = PortStats();
+        
+        return outputSockets_[key];
+    }
+    
+    return nullptr;
+}
+
+static PortStats* GetOutputSocketStats(string surfaceName, string address, int outputPort)
+{
+    string key = GetOutputSocketKey(surfaceName, address, outputPort);
+    
+    if(outputSocketStats_.count(key) > 0)
+        return &outputSocketStats_[key];
+    
+    return nullptr;
+}
+
+// Called on reset once the surfaces that went away have been deleted, anything the new config still uses stays open
+static void ReleaseUnusedIO(const set<int> &midiInputPorts, const set<int> &midiOutputPorts, const set<string> &oscInputSockets, const set<string> &oscOutputSockets)
+{
+    for(auto it = midiInputs_.begin(); it != midiInputs_.end(); )
+    {
+        MidiInputPort* input = it->second;
+        
+        // A kept port whose surfaces all went, or were rebuilt without the thread, runs it for nothing
+        if(input->shouldRun_ && input->queues_.size() == 0)
+        {
+            input->shouldRun_ = false;
+            input->inputThread_.join();
+        }
+        
+        if(midiInputPorts.count(it->first) > 0)
+        {
+            ++it;
+            continue;
+        }
+        
+        if(input->shouldRun_)
+        {
+            input->shouldRun_ = false;
+            input->inputThread_.join();
+        }
+        
+        input->midiInput_->stop();
+        delete input->midiInput_;
+        
+        for(auto queue : input->queues_)
+            delete queue;
+        
+        delete input;
+        it = midiInputs_.erase(it);
+    }
+    
+    for(auto it = midiOutputs_.begin(); it != midiOutputs_.end(); )
+    {
+        if(midiOutputPorts.count(it->first) > 0)
+        {
+            // Surfaces on the port are rebuilt when this changes, the new ones start the thread again if they need it
+            if( ! GetIsMidiOutputThreaded(it->first))
+                StopMidiOutputThread(it->second);
+            
+            it->second->bytesPerSecond_ = GetMidiOutputBytesPerSecond(it->first); // the thread picks a new budget up as it goes
+            
+            ++it;
+            continue;
+        }
+        
+        StopMidiOutputThread(it->second);
+        
+        delete it->second->midiOutput_;
+        delete it->second->queue_;
+        delete it->second;
+        it = midiOutputs_.erase(it);
+    }
+    
+    for(auto it = oscInputThreads_.begin(); it != oscInputThreads_.end(); )
+    {
+        if(oscInputSockets.count(it->first) > 0 && GetCSIOption("OSCInputThread"))
+        {
+            ++it;
+            continue;
+        }
+        
+        OSCInputThread* inputThread = it->second;
+        
+        inputThread->shouldRun_ = false;
+        inputThread->inputThread_.join();
+        
+        delete inputThread->queue_;
+        delete inputThread;
+        it = oscInputThreads_.erase(it);
+    }
+    
+    for(auto it = inputSockets_.begin(); it != inputSockets_.end(); )
+    {
+        if(oscInputSockets.count(it->first) > 0)
+        {
+            ++it;
+            continue;
+        }
+        
+        delete it->second;
+        it = inputSockets_.erase(it);
+    }
+    
+    for(auto it = outputSockets_.begin(); it != outputSockets_.end(); )
+    {
+        if(oscOutputSockets.count(it->first) > 0)
+        {
+            ++it;
+            continue;
+        }
+        
+        delete it->second;
+        outputSocketStats_.erase(it->first);
+        it = outputSockets_.erase(it);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Feedback Workers
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class FeedbackWorkers // apply the surfaces' snapshotted updates in parallel, the main thread takes surfaces too while it waits
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    vector<thread> workers_;
+    mutex mutex_;
+    condition_variable batchReady_;
+    condition_variable batchDone_;
+    const vector<ControlSurface*>* surfaces_ = nullptr;
+    atomic<int> nextSurface_ { 0 };
+    int batchNumber_ = 0;
+    int numBusyWorkers_ = 0;
+    bool shouldRun_ = false;
+    
+    void ComputeSurfaces()
+    {
+        for(int i = nextSurface_++; i < (int)surfaces_->size(); i = nextSurface_++)
+            (*surfaces_)[i]->ComputeFeedback();
+    }
+    
+    void WorkerProc()
+    {
+        int batchNumber = 0;
+        
+        unique_lock<mutex> lock(mutex_);
+        
+        while(true)
+        {
+            batchReady_.wait(lock, [&] { return ! shouldRun_ || batchNumber_ != batchNumber; });
+            
+            if( ! shouldRun_)
+                return;
+            
+            batchNumber = batchNumber_;
+            
+            lock.unlock();
+            ComputeSurfaces();
+            lock.lock();
+            
+            if(--numBusyWorkers_ == 0)
+                batchDone_.notify_one();
+        }
+    }
+    
+public:
+    ~FeedbackWorkers()
+    {
+        Stop();
+    }
+    
+    int GetNumWorkers() { return (int)workers_.size(); }
+    
+    void Start(int numWorkers)
+    {
+        if(numWorkers == (int)workers_.size())
+            return;
+        
+        Stop();
+        
+        shouldRun_ = true;
+        
+        for(int i = 0; i < numWorkers; i++)
+            workers_.push_back(thread(&FeedbackWorkers::WorkerProc, this));
+    }
+    
+    void Stop()
+    {
+        {
+            lock_guard<mutex> lock(mutex_);
+            shouldRun_ = false;
+        }
+        
+        batchReady_.notify_all();
+        
+        for(auto &worker : workers_)
+            worker.join();
+        
+        workers_.clear();
+    }
+    
+    void Compute(const vector<ControlSurface*> &surfaces)
+    {
+        if(surfaces.size() == 0)
+            return;
+        
+        {
+            lock_guard<mutex> lock(mutex_);
+            surfaces_ = &surfaces;
+            nextSurface_ = 0;
+            numBusyWorkers_ = (int)workers_.size();
+            batchNumber_++;
+        }
+        
+        batchReady_.notify_all();
+        
+        ComputeSurfaces();
+        
+        unique_lock<mutex> lock(mutex_);
+        batchDone_.wait(lock, [this] { return numBusyWorkers_ == 0; });
+    }
+};
+
+static FeedbackWorkers feedbackWorkers_;
+
+const int MaxFeedbackWorkers = 16;
+
+int GetNumFeedbackWorkers()
+{
+    return feedbackWorkers_.GetNumWorkers();
+}
+
+void ComputeFeedback(const vector<ControlSurface*> &surfaces)
+{
+    feedbackWorkers_.Compute(surfaces);
+}
+
+void ShutdownFeedbackWorkers()
+{
+    feedbackWorkers_.Stop();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Trace Log
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void AppendJSONString(string &output, const char* text)
+{
+    output += "\"";
+    
+    for(const char* c = text; *c != 0; c++)
+    {
+        if(*c == '"' || *c == '\\')
+        {
+            output += '\\';
+            output += *c;
+        }
+        else if((unsigned char)*c < 0x20)
+        {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", *c);
+            output += buffer;
+        }
+        else
+            output += *c;
+    }
+    
+    output += "\"";
+}
+
+const long TraceLogFileMaxSize = 4 * 1024 * 1024; // then it's moved to CSI.log.1 and a new one is started
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TraceLog
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    TraceQueue queue_;
+    thread formatThread_;
+    atomic<bool> shouldRun_ { false };
+    
+    mutex consoleMutex_;
+    string consoleText_;
+    atomic<bool> hasConsoleText_ { false };
+    
+    string logFilePath_ = ""; // empty means the console
+    ofstream logFile_;
+    long logFileSize_ = 0;
+    int numDroppedReported_ = 0;
+    
+    // Chrome trace event JSON, loads in Perfetto or chrome://tracing
+    atomic<bool> isCapturing_ { false };
+    string captureFilePath_ = "";
+    ofstream captureFile_;
+    double captureStartTime_ = 0.0;
+    bool isFirstCaptureEvent_ = true;
+    int numOpenSpans_ = 0; // main thread, each one holds a queue slot for its end
+    
+    static void CopyString(char* destination, const string &source, size_t size)
+    {
+        size_t length = source.size() < size - 1 ? source.size() : size - 1;
+        memcpy(destination, source.c_str(), length);
+        destination[length] = 0;
+    }
+    
+    void Format(const TraceRecord &record, string &output)
+    {
+        char buffer[512];
+        
+        switch(record.type)
+        {
+            case TraceMidiIn:
+                snprintf(buffer, sizeof(buffer), "IN <- %s %02x  %02x  %02x \n", record.surface, record.bytes[0], record.bytes[1], record.bytes[2]);
+                output += buffer;
+                break;
+                
+            case TraceMidiOut:
+                if(record.bytes[0] != 0xf0)
+                {
+                    snprintf(buffer, sizeof(buffer), "OUT->%s  %02x  %02x  %02x \n", record.surface, record.bytes[0], record.bytes[1], record.bytes[2]);
+                    output += buffer;
+                }
+                else
+                {
+                    output += string("OUT->") + record.surface + " ";
+                    
+                    for(int i = 0; i < record.numBytes && i < TraceMaxMidiBytes; i++)
+                    {
+                        snprintf(buffer, sizeof(buffer), "%02x ", record.bytes[i]);
+                        output += buffer;
+                    }
+                    
+                    if(record.numBytes > TraceMaxMidiBytes)
+                    {
+                        snprintf(buffer, sizeof(buffer), "... (%d bytes)", record.numBytes);
+                        output += buffer;
+                    }
+                    
+                    output += "\n";
+                }
+                break;
+                
+            case TraceOSCIn:
+                snprintf(buffer, sizeof(buffer), "IN <- %s %s  %f  \n", record.surface, record.address, record.value);
+                output += buffer;
+                break;
+                
+            case TraceOSCOut:
+                output += string("OUT->") + record.surface + " " + record.address + " " + (record.hasValue ? to_string(record.value) : string(record.text)) + "\n";
+                break;
+                
+            case TraceWidgetIn:
+                snprintf(buffer, sizeof(buffer), "IN <- %s %s %f\n", record.surface, record.address, record.value);
+                output += buffer;
+                break;
+                
+            case TraceZoneLoad:
+                output += string(record.address) + "->" + "LoadingZone---->" + record.surface + "\n";
+                break;
+                
+            case TraceText:
+                output += string(record.surface) + " " + record.text + "\n";
+                break;
+                
+            default:
+                break;
+        }
+    }
+    
+    void Capture(const TraceRecord &record)
+    {
+        if(record.type == TraceCaptureBegin)
+        {
+            CloseCapture();
+            
+            captureFile_.open(captureFilePath_, ios::trunc);
+            captureFile_ << "{\"traceEvents\":[\n";
+            captureStartTime_ = record.timestamp;
+            isFirstCaptureEvent_ = true;
+            return;
+        }
+        
+        if( ! captureFile_.is_open())
+            return;
+        
+        if(record.type == TraceCaptureEnd)
+        {
+            CloseCapture();
+            return;
+        }
+        
+        // Everything happens on the main thread, so one track holds the frames and the messages they handled
+        string event = isFirstCaptureEvent_ ? "{" : ",\n{";
+        isFirstCaptureEvent_ = false;
+        
+        char buffer[512];
+        snprintf(buffer, sizeof(buffer), "\"pid\":1,\"tid\":1,\"ts\":%.3f,", (record.timestamp - captureStartTime_) * 1000.0);
+        event += buffer;
+        
+        if(record.type == TraceSpanEnd)
+            event += "\"ph\":\"E\"";
+        else if(record.type == TraceSpanBegin)
+        {
+            event += "\"ph\":\"B\",\"cat\":\"csi\",\"name\":";
+            AppendJSONString(event, record.address);
+            event += ",\"args\":{\"surface\":";
+            AppendJSONString(event, record.surface);
+            event += ",\"detail\":";
+            AppendJSONString(event, record.text);
+            event += "}";
+        }
+        else
+        {
+            string message = "";
+            Format(record, message);
+            
+            if(message.size() > 0 && message.back() == '\n')
+                message.pop_back();
+            
+            const char* name = "Message";
+            
+            if(record.type == TraceMidiIn)
+                name = "MIDI in";
+            else if(record.type == TraceMidiOut)
+                name = "MIDI out";
+            else if(record.type == TraceOSCIn)
+                name = "OSC in";
+            else if(record.type == TraceOSCOut)
+                name = "OSC out";
+            else if(record.type == TraceWidgetIn)
+                name = "Widget in";
+            else if(record.type == TraceZoneLoad)
+                name = "Zone load";
+            
+            event += "\"ph\":\"i\",\"s\":\"t\",\"cat\":\"io\",\"name\":";
+            AppendJSONString(event, name);
+            event += ",\"args\":{\"surface\":";
+            AppendJSONString(event, record.surface);
+            event += ",\"message\":";
+            AppendJSONString(event, message.c_str());
+            event += "}";
+        }
+        
+        event += "}";
+        captureFile_ << event;
+    }
+    
+    void CloseCapture()
+    {
+        if( ! captureFile_.is_open())
+            return;
+        
+        captureFile_ << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        captureFile_.close();
+    }
+    
+    void WriteToFile(const string &text)
+    {
+        if( ! logFile_.is_open())
+        {
+            logFile_.open(logFilePath_, ios::app);
+            logFileSize_ = logFile_.is_open() ? (long)logFile_.tellp() : 0;
+        }
+        
+        if( ! logFile_.is_open())
+            return;
+        
+        logFile_ << text;
+        logFile_.flush();
+        logFileSize_ += text.size();
+        
+        if(logFileSize_ > TraceLogFileMaxSize)
+        {
+            logFile_.close();
+            
+            string previousPath = logFilePath_ + ".1";
+            remove(previousPath.c_str());
+            rename(logFilePath_.c_str(), previousPath.c_str());
+        }
+    }
+    
+    void FormatThreadProc()
+    {
+        TraceRecord record;
+        string output;
+        
+        while(true)
+        {
+            bool isStopping = ! shouldRun_;
+            
+            while(queue_.Pop(record))
+            {
+                if(record.type >= TraceSpanBegin || captureFile_.is_open())
+                    Capture(record);
+                
+                if( ! record.isDisplayed)
+                    continue;
+                
+                if(logFilePath_ != "")
+                {
+                    char timestamp[32];
+                    snprintf(timestamp, sizeof(timestamp), "%.3f ", record.timestamp);
+                    output += timestamp;
+                }
+                
+                Format(record, output);
+            }
+            
+            if(queue_.GetNumDropped() != numDroppedReported_)
+            {
+                output += "CSI trace dropped " + to_string(queue_.GetNumDropped() - numDroppedReported_) + " records, trace queue full\n";
+                numDroppedReported_ = queue_.GetNumDropped();
+            }
+            
+            if(output.size() > 0)
+            {
+                if(logFilePath_ != "")
+                    WriteToFile(output);
+                else
+                {
+                    lock_guard<mutex> lock(consoleMutex_);
+                    consoleText_ += output;
+                    hasConsoleText_ = true;
+                }
+                
+                output.clear();
+            }
+            
+            if(isStopping)
+                break;
+            
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+        
+        logFile_.close();
+        CloseCapture();
+    }
+    
+    void Start()
+    {
+        shouldRun_ = true;
+        formatThread_ = thread(&TraceLog::FormatThreadProc, this);
+    }
+    
+    bool Push(TraceRecord &record)
+    {
+        if( ! shouldRun_)
+            Start();
+        
+        record.timestamp = DAW::GetPreciseNumberOfMilliseconds();
+        
+        // One slot stays free for a capture toggle and one for the end of every open span, so whatever else is dropped the capture is still well formed
+        int numReserved = numOpenSpans_ + 1;
+        
+        if(record.type == TraceSpanBegin)
+            numReserved++;
+        else if(record.type == TraceSpanEnd || record.type == TraceCaptureBegin || record.type == TraceCaptureEnd)
+            numReserved--;
+        
+        if( ! queue_.Push(record, numReserved))
+            return false;
+        
+        if(record.type == TraceSpanBegin)
+            numOpenSpans_++;
+        else if(record.type == TraceSpanEnd && numOpenSpans_ > 0)
+            numOpenSpans_--;
+        
+        return true;
+    }
+    
+public:
+    ~TraceLog() { Stop(); }
+    
+    void SetLogFilePath(const string &logFilePath)
+    {
+        if(logFilePath == logFilePath_)
+            return;
+        
+        Stop(); // the thread owns the file while it runs, the next record starts it again
+        logFilePath_ = logFilePath;
+    }
+    
+    void Stop()
+    {
+        if(shouldRun_)
+        {
+            shouldRun_ = false;
+            formatThread_.join();
+        }
+        
+        isCapturing_ = false; // the thread wrote out whatever capture it had open
+    }
+    
+    bool GetIsCapturing() { return isCapturing_; }
+    
+    bool ToggleCapture(const string &captureFilePath)
+    {
+        TraceRecord record;
+        
+        if( ! isCapturing_)
+        {
+            captureFilePath_ = captureFilePath; // handed over with the record that opens it
+            record.type = TraceCaptureBegin;
+        }
+        else
+            record.type = TraceCaptureEnd;
+        
+        record.isDisplayed = false;
+        record.surface[0] = record.address[0] = record.text[0] = 0;
+        
+        if( ! Push(record)) // only if the last toggle hasn't been picked up yet
+            return false;
+        
+        isCapturing_ = ! isCapturing_;
+        
+        return true;
+    }
+    
+    void TraceMidi(TraceRecordType type, const string &surfaceName, const unsigned char* bytes, int numBytes, bool isDisplayed)
+    {
+        if( ! isDisplayed && ! isCapturing_)
+            return;
+        
+        TraceRecord record;
+        record.type = type;
+        record.isDisplayed = isDisplayed;
+        record.numBytes = numBytes;
+        memcpy(record.bytes, bytes, numBytes < TraceMaxMidiBytes ? numBytes : TraceMaxMidiBytes);
+        CopyString(record.surface, surfaceName, sizeof(record.surface));
+        
+        Push(record);
+    }
+    
+    bool TraceMessage(TraceRecordType type, const string &surfaceName, const string &address, double value, const string* text, bool isDisplayed)
+    {
+        if( ! isDisplayed && ! isCapturing_ && type != TraceSpanEnd) // a span that began in a capture ends even if the capture has
+            return false;
+        
+        TraceRecord record;
+        record.type = type;
+        record.isDisplayed = isDisplayed;
+        record.value = value;
+        record.hasValue = text == nullptr;
+        CopyString(record.surface, surfaceName, sizeof(record.surface));
+        CopyString(record.address, address, sizeof(record.address));
+        CopyString(record.text, text != nullptr ? *text : "", sizeof(record.text));
+        
+        return Push(record);
+    }
+    
+    void FlushToConsole()
+    {
+        if( ! hasConsoleText_)
+            return;
+        
+        string text;
+        
+        {
+            lock_guard<mutex> lock(consoleMutex_);
+            text.swap(consoleText_);
+            hasConsoleText_ = false;
+        }
+        
+        DAW::ShowConsoleMsg(text.c_str());
+    }
+};
+
+static TraceLog traceLog_;
+
+void TraceMidi(TraceRecordType type, const string &surfaceName, const unsigned char* bytes, int numBytes, bool isDisplayed)
+{
+    traceLog_.TraceMidi(type, surfaceName, bytes, numBytes, isDisplayed);
+}
+
+bool TraceMessage(TraceRecordType type, const string &surfaceName, const string &address, double value, bool isDisplayed)
+{
+    return traceLog_.TraceMessage(type, surfaceName, address, value, nullptr, isDisplayed);
+}
+
+bool TraceMessage(TraceRecordType type, const string &surfaceName, const string &address, const string &text, bool isDisplayed)
+{
+    return traceLog_.TraceMessage(type, surfaceName, address, 0.0, &text, isDisplayed);
+}
+
+bool GetIsCapturingTrace()
+{
+    return traceLog_.GetIsCapturing();
+}
+
+void ToggleTraceCapture()
+{
+    string captureFilePath = string(DAW::GetResourcePath()) + "/CSI/CSI_trace.json";
+    
+    if( ! traceLog_.ToggleCapture(captureFilePath))
+    {
+        DAW::ShowConsoleMsg("CSI trace queue is full, toggle capture again in a moment\n");
+        return;
+    }
+    
+    DAW::ShowConsoleMsg(((GetIsCapturingTrace() ? "CSI trace capture started, toggle again to write " : "CSI trace capture written to ") + captureFilePath + "\n").c_str());
+}
+
+void FlushTraceToConsole()
+{
+    traceLog_.FlushToConsole();
+}
+
+void ShutdownTraceLog()
+{
+    traceLog_.Stop();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Parsing
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+
+static string ExpandChannelNumber(const string &source, const string &numStr)
+{
+    size_t pos = source.find('|');
+    
+    if(pos == string::npos)
+        return source;
+    
+    string expanded = source;
+    
+    for( ; pos != string::npos; pos = expanded.find('|', pos + numStr.size()))
+        expanded.replace(pos, 1, numStr);
+    
+    return expanded;
+}
+
+// Cheap stand-in for the file's contents when deciding whether a reset has to rebuild what was loaded from it
+static string GetFileStamp(const string &filePath)
+{
+    struct stat fileStat;
+    
+    if(stat(filePath.c_str(), &fileStat) != 0)
+        return "\x1f-";
+    
+    return "\x1f" + to_string((long long)fileStat.st_mtime) + ":" + to_string((long long)fileStat.st_size);
+}
+
+// Calls visit for every folder and regular file below path, skipping hidden entries, folder paths end with a slash
+static void WalkFolder(const string &path, const function<void(const string &entryPath, bool isFolder)> &visit)
+{
+    if (auto dir = opendir(path.c_str())) {
+        while (auto f = readdir(dir)) {
+            if (f->d_name[0] == '.') continue;
+            if (f->d_type == DT_DIR)
+            {
+                string folderPath = path + f->d_name + "/";
+                visit(folderPath, true);
+                WalkFolder(folderPath, visit);
+            }
+            
+            if (f->d_type == DT_REG)
+                visit(path + f->d_name, false);
+        }
+        closedir(dir);
+    }
+}
+
+static void listZoneFiles(const string &path, vector<string> &results)
+{
+    regex rx(".*\\.zon$");
+    
+    WalkFolder(path, [&](const string &entryPath, bool isFolder)
+    {
+        if( ! isFolder && regex_match(entryPath, rx))
+            results.push_back(entryPath);
+    });
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TokenizedLine
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    int lineNumber = 0;
+    vector<string> tokens;
+};
+
+typedef vector<TokenizedLine> TokenizedFile;
+
+// Blank and comment lines are dropped, zone files also lose trailing comments
+static void TokenizeFile(const string &filePath, bool isZoneFile, TokenizedFile &tokenizedFile)
+{
+    regex tabChars(TabChars);
+    regex crlfChars(CRLFChars);
+    regex outerSpaces("^\\s+|\\s+$");
+    
+    ifstream file(filePath);
+    
+    int lineNumber = 0;
+    
+    for (string line; getline(file, line) ; )
+    {
+        line = regex_replace(line, tabChars, " ");
+        line = regex_replace(line, crlfChars, "");
+        
+        lineNumber++;
+        
+        if(isZoneFile)
+        {
+            line = line.substr(0, line.find("//")); // remove trailing comments
+            line = regex_replace(line, outerSpaces, "", regex_constants::format_default);
+        }
+        
+        if(line == "" || line[0] == '/') // ignore blank lines and comment lines
+            continue;
+        
+        vector<string> tokens(GetTokens(line));
+        
+        if(tokens.size() > 0)
+            tokenizedFile.push_back({ lineNumber, tokens });
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TokenizedFileCache
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Widget and zone files are read and tokenized by worker threads while REAPER carries on,
+    // the main thread only builds objects from the tokens and does any file nobody has picked up yet itself
+    struct Entry
+    {
+        string filePath;
+        bool isZoneFile = false;
+        bool isClaimed = false;
+        string stamp; // the file's time and size when it was read, set before tokensReady
+        promise<TokenizedFile> tokens;
+        shared_future<TokenizedFile> tokensReady;
+    };
+    
+    WDL_Mutex mutex_;
+    map<string, Entry*> entries_;
+    vector<Entry*> pending_;
+    vector<Entry*> retired_;
+    vector<string> pendingZoneFolders_;
+    set<string> requestedZoneFolders_;
+    map<string, vector<string>> zoneFolderFiles_;
+    int generation_ = 0; // bumped by Clear, a folder listed for an earlier one is thrown away
+    int numRunningWorkers_ = 0; // workers are detached, retired entries are only deleted once none are left
+    
+    Entry* AddEntry(const string &filePath, bool isZoneFile) // caller holds mutex_
+    {
+        if(entries_.count(filePath) > 0)
+            return nullptr;
+        
+        Entry* entry = new Entry();
+        entry->filePath = filePath;
+        entry->isZoneFile = isZoneFile;
+        entry->tokensReady = entry->tokens.get_future().share();
+        entries_[filePath] = entry;
+        
+        return entry;
+    }
+    
+    static void Tokenize(Entry* entry)
+    {
+        TokenizedFile tokenizedFile;
+        
+        try
+        {
+            entry->stamp = GetFileStamp(entry->filePath);
+            TokenizeFile(entry->filePath, entry->isZoneFile, tokenizedFile);
+        }
+        catch (exception &e) {} // the parser reports what's missing on the main thread
+        
+        entry->tokens.set_value(tokenizedFile);
+    }
+    
+    void WorkerProc()
+    {
+        while(true)
+        {
+            Entry* entry = nullptr;
+            string zoneFolder = "";
+            int generation = 0;
+            
+            {
+                WDL_MutexLock lock(&mutex_);
+                
+                generation = generation_;
+                
+                if(pendingZoneFolders_.size() > 0)
+                {
+                    zoneFolder = pendingZoneFolders_.back();
+                    pendingZoneFolders_.pop_back();
+                }
+                else
+                {
+                    while(pending_.size() > 0 && entry == nullptr)
+                    {
+                        if( ! pending_.back()->isClaimed)
+                        {
+                            entry = pending_.back();
+                            entry->isClaimed = true;
+                        }
+                        
+                        pending_.pop_back();
+                    }
+                    
+                    if(entry == nullptr)
+                    {
+                        numRunningWorkers_--;
+                        return;
+                    }
+                }
+            }
+            
+            if(zoneFolder != "")
+            {
+                vector<string> zoneFilenames;
+                
+                try
+                {
+                    listZoneFiles(zoneFolder, zoneFilenames);
+                }
+                catch (exception &e) {}
+                
+                WDL_MutexLock lock(&mutex_);
+                
+                if(generation != generation_)
+                    continue;
+                
+                for(auto zoneFilename : zoneFilenames)
+                    if(Entry* newEntry = AddEntry(zoneFilename, true))
+                        pending_.push_back(newEntry);
+                
+                zoneFolderFiles_[zoneFolder] = zoneFilenames;
+            }
+            else
+                Tokenize(entry);
+        }
+    }
+    
+public:
+    ~TokenizedFileCache()
+    {
+        Shutdown();
+    }
+    
+    void Prefetch(const vector<string> &widgetFiles, const vector<string> &zoneFolders)
+    {
+        int numWorkers = thread::hardware_concurrency() > 2 ? thread::hardware_concurrency() - 1 : 1;
+        
+        if(numWorkers > 4)
+            numWorkers = 4;
+        
+        WDL_MutexLock lock(&mutex_);
+        
+        for(auto widgetFile : widgetFiles)
+            if(Entry* entry = AddEntry(widgetFile, false))
+                pending_.push_back(entry);
+        
+        pendingZoneFolders_.insert(pendingZoneFolders_.end(), zoneFolders.begin(), zoneFolders.end());
+        requestedZoneFolders_.insert(zoneFolders.begin(), zoneFolders.end());
+        
+        // Workers still finishing a previous Prefetch pick up this one's files too
+        for( ; numRunningWorkers_ < numWorkers; numRunningWorkers_++)
+            thread(&TokenizedFileCache::WorkerProc, this).detach();
+    }
+    
+    // Lets the main thread poll instead of waiting on a worker, files nobody asked for are read by Get itself
+    bool GetIsReady(const string &filePath)
+    {
+        WDL_MutexLock lock(&mutex_);
+        
+        if(entries_.count(filePath) == 0)
+            return true;
+        
+        return entries_[filePath]->tokensReady.wait_for(chrono::seconds(0)) == future_status::ready;
+    }
+    
+    // False while a worker has yet to list the folder, folders nobody asked for are listed here
+    bool GetZoneFiles(const string &zoneFolder, vector<string> &zoneFiles)
+    {
+        {
+            WDL_MutexLock lock(&mutex_);
+            
+            if(zoneFolderFiles_.count(zoneFolder) > 0)
+            {
+                zoneFiles = zoneFolderFiles_[zoneFolder];
+                return true;
+            }
+            
+            if(requestedZoneFolders_.count(zoneFolder) > 0)
+                return false;
+        }
+        
+        listZoneFiles(zoneFolder, zoneFiles);
+        
+        return true;
+    }
+    
+    // What the file was when it was read, files nobody has read yet are looked at here
+    string GetStamp(const string &filePath)
+    {
+        {
+            WDL_MutexLock lock(&mutex_);
+            
+            if(entries_.count(filePath) > 0 && entries_[filePath]->tokensReady.wait_for(chrono::seconds(0)) == future_status::ready)
+                return entries_[filePath]->stamp;
+        }
+        
+        return GetFileStamp(filePath);
+    }
     
-    if(newInput)
+    bool GetIsZoneFolderReady(const string &zoneFolder)
     {
-        newInput->start();
-        midiInputs_[inputPort] = new MidiInputPort(inputPort, newInput);
-        return newInput;
+        vector<string> zoneFiles;
+        
+        if( ! GetZoneFiles(zoneFolder, zoneFiles))
+            return false;
+        
+        for(auto &zoneFile : zoneFiles)
+            if( ! GetIsReady(zoneFile))
+                return false;
+        
+        return true;
     }
     
-    return nullptr;
-}
-
-static midi_Output* GetMidiOutputForPort(int outputPort)
-{
-    if(midiOutputs_.count(outputPort) > 0)
-        return midiOutputs_[outputPort]->midiOutput_; // return existing
+    const TokenizedFile &Get(const string &filePath, bool isZoneFile)
+    {
+        Entry* entry = nullptr;
+        bool shouldTokenize = false;
+        
+        {
+            WDL_MutexLock lock(&mutex_);
+            
+            if(entries_.count(filePath) > 0)
+                entry = entries_[filePath];
+            else
+                entry = AddEntry(filePath, isZoneFile);
+            
+            if( ! entry->isClaimed)
+            {
+                entry->isClaimed = true;
+                shouldTokenize = true;
+            }
+        }
+        
+        if(shouldTokenize)
+            Tokenize(entry);
+        
+        return entry->tokensReady.get();
+    }
     
-    // otherwise make new
-    midi_Output* newOutput = DAW::CreateMIDIOutput(outputPort, false, NULL);
+    // The next Get reads the file again, the old tokens live on until Clear since parsers may still hold them
+    void Forget(const string &filePath)
+    {
+        WDL_MutexLock lock(&mutex_);
+        
+        if(entries_.count(filePath) > 0)
+        {
+            retired_.push_back(entries_[filePath]);
+            entries_.erase(filePath);
+        }
+    }
     
-    if(newOutput)
+    // Doesn't wait for the workers, one busy with a file of the old set finishes it into a retired entry
+    void Clear()
     {
-        midiOutputs_[outputPort] = new MidiOutputPort(outputPort, newOutput);
-        return newOutput;
+        WDL_MutexLock lock(&mutex_);
+        
+        generation_++;
+        pending_.clear();
+        pendingZoneFolders_.clear();
+        requestedZoneFolders_.clear();
+        zoneFolderFiles_.clear();
+        
+        for(auto [filePath, entry] : entries_)
+            retired_.push_back(entry);
+        
+        entries_.clear();
+        
+        if(numRunningWorkers_ > 0)
+            return;
+        
+        for(auto entry : retired_)
+            delete entry;
+        
+        retired_.clear();
     }
     
-    return nullptr;
-}
+    void Shutdown()
+    {
+        Clear();
+        
+        while(true)
+        {
+            {
+                WDL_MutexLock lock(&mutex_);
+                
+                if(numRunningWorkers_ == 0)
+                    break;
+            }
+            
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        
+        Clear();
+    }
+};
 
-void ShutdownMidiIO()
+static TokenizedFileCache tokenizedFiles_;
+
+static void listFiles(const string &path, vector<string> &results)
 {
-    for(auto [index, input] : midiInputs_)
-        input->midiInput_->stop();
+    WalkFolder(path, [&](const string &entryPath, bool isFolder)
+    {
+        if( ! isFolder)
+            results.push_back(entryPath);
+    });
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// OSC I/O Manager
+class FileWatcher
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-static map<string, oscpkt::UdpSocket*> inputSockets_;
-static map<string, oscpkt::UdpSocket*> outputSockets_;
-
-static oscpkt::UdpSocket* GetInputSocketForPort(string surfaceName, int inputPort)
 {
-    if(inputSockets_.count(surfaceName) > 0)
-        return inputSockets_[surfaceName]; // return existing
-    
-    // otherwise make new
-    oscpkt::UdpSocket* newInputSocket = new oscpkt::UdpSocket();
+    // Watches the CSI Zones and Surfaces folders, Manager::Run picks up the changed files each frame
+    vector<string> folders_;
+    thread watchThread_;
+    atomic<bool> shouldRun_ { false };
+    WDL_Mutex mutex_;
+    vector<string> changedFiles_;
     
-    if(newInputSocket)
+    void AddChangedFile(const string &filePath)
     {
-        newInputSocket->bindTo(inputPort);
-        
-        if (! newInputSocket->isOk())
-        {
-            //cerr << "Error opening port " << PORT_NUM << ": " << inSocket_.errorMessage() << "\n";
-            return nullptr;
-        }
+        WDL_MutexLock lock(&mutex_);
         
-        inputSockets_[surfaceName] = newInputSocket;
-        
-        return inputSockets_[surfaceName];
+        if(find(changedFiles_.begin(), changedFiles_.end(), filePath) == changedFiles_.end())
+            changedFiles_.push_back(filePath);
     }
     
-    return nullptr;
-}
-
-static oscpkt::UdpSocket* GetOutputSocketForAddressAndPort(string surfaceName, string address, int outputPort)
-{
-    if(outputSockets_.count(surfaceName) > 0)
-        return outputSockets_[surfaceName]; // return existing
+#ifdef __linux__
+    void AddWatch(int inotifyFd, const string &path, map<int, string> &watchedFolders)
+    {
+        int watch = inotify_add_watch(inotifyFd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        
+        if(watch >= 0)
+            watchedFolders[watch] = path;
+    }
     
-    // otherwise make new
-    oscpkt::UdpSocket* newOutputSocket = new oscpkt::UdpSocket();
+    void AddWatches(int inotifyFd, const string &path, map<int, string> &watchedFolders)
+    {
+        AddWatch(inotifyFd, path, watchedFolders);
+        
+        WalkFolder(path, [&](const string &entryPath, bool isFolder)
+        {
+            if(isFolder)
+                AddWatch(inotifyFd, entryPath, watchedFolders);
+        });
+    }
     
-    if(newOutputSocket)
+    bool WatchWithInotify()
     {
-        if( ! newOutputSocket->connectTo(address, outputPort))
+        int inotifyFd = inotify_init1(IN_NONBLOCK);
+        
+        if(inotifyFd < 0)
+            return false;
+        
+        map<int, string> watchedFolders;
+        
+        for(auto folder : folders_)
+            AddWatches(inotifyFd, folder, watchedFolders);
+        
+        char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        
+        while(shouldRun_)
         {
-            //cerr << "Error connecting " << remoteDeviceIP_ << ": " << outSocket_.errorMessage() << "\n";
-            return nullptr;
+            pollfd pollFd = { inotifyFd, POLLIN, 0 };
+            
+            if(poll(&pollFd, 1, 250) <= 0)
+                continue;
+            
+            ssize_t length = 0;
+            
+            while((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+            {
+                for(char* ptr = buffer; ptr < buffer + length; ptr += sizeof(struct inotify_event) + ((struct inotify_event*)ptr)->len)
+                {
+                    const struct inotify_event* event = (const struct inotify_event*)ptr;
+                    
+                    if(event->len == 0 || watchedFolders.count(event->wd) == 0 || event->name[0] == '.')
+                        continue;
+                    
+                    string filePath = watchedFolders[event->wd] + event->name;
+                    
+                    if(event->mask & IN_ISDIR)
+                        AddWatches(inotifyFd, filePath + "/", watchedFolders);
+                    else if(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                        AddChangedFile(filePath);
+                }
+            }
         }
         
-        newOutputSocket->bindTo(outputPort);
+        close(inotifyFd);
         
-        if ( ! newOutputSocket->isOk())
+        return true;
+    }
+#endif
+    
+    void WatchByPolling()
+    {
+        map<string, time_t> modifiedTimes;
+        bool isFirstScan = true;
+        
+        while(shouldRun_)
         {
-            //cerr << "Error opening port " << outPort_ << ": " << outSocket_.errorMessage() << "\n";
-            return nullptr;
+            vector<string> filePaths;
+            
+            for(auto folder : folders_)
+                listFiles(folder, filePaths);
+            
+            for(auto filePath : filePaths)
+            {
+                struct stat fileInfo;
+                
+                if(stat(filePath.c_str(), &fileInfo) != 0)
+                    continue;
+                
+                if( ! isFirstScan && (modifiedTimes.count(filePath) == 0 || modifiedTimes[filePath] != fileInfo.st_mtime))
+                    AddChangedFile(filePath);
+                
+                modifiedTimes[filePath] = fileInfo.st_mtime;
+            }
+            
+            isFirstScan = false;
+            
+            for(int i = 0; i < 4 && shouldRun_; i++)
+                this_thread::sleep_for(chrono::milliseconds(250));
         }
-
-        outputSockets_[surfaceName] = newOutputSocket;
+    }
+    
+    void WatchProc()
+    {
+#ifdef __linux__
+        if(WatchWithInotify())
+            return;
+#endif
+        WatchByPolling();
+    }
+    
+public:
+    ~FileWatcher()
+    {
+        Stop();
+    }
+    
+    void Start(const vector<string> &folders)
+    {
+        Stop();
         
-        return outputSockets_[surfaceName];
+        folders_ = folders;
+        shouldRun_ = true;
+        watchThread_ = thread(&FileWatcher::WatchProc, this);
     }
     
-    return nullptr;
-}
-
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////////
-// Parsing
-//////////////////////////////////////////////////////////////////////////////////////////////
-
-
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-struct ActionTemplate
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-{
-    string actionName;
-    vector<string> params;
-    vector<vector<string>> properties;
-    bool isFeedbackInverted;
-    double holdDelayAmount;
+    void Stop()
+    {
+        shouldRun_ = false;
+        
+        if(watchThread_.joinable())
+            watchThread_.join();
+    }
     
-    ActionTemplate(string action, vector<string> prams, bool isInverted, double amount) : actionName(action), params(prams), isFeedbackInverted(isInverted), holdDelayAmount(amount) {}
+    void GetChangedFiles(vector<string> &changedFiles)
+    {
+        WDL_MutexLock lock(&mutex_);
+        
+        changedFiles.swap(changedFiles_);
+    }
 };
 
-static void listZoneFiles(const string &path, vector<string> &results)
+static FileWatcher fileWatcher_;
+
+void ShutdownFileParsing()
 {
-    regex rx(".*\\.zon$");
-    
-    if (auto dir = opendir(path.c_str())) {
-        while (auto f = readdir(dir)) {
-            if (!f->d_name || f->d_name[0] == '.') continue;
-            if (f->d_type == DT_DIR)
-                listZoneFiles(path + f->d_name + "/", results);
-            
-            if (f->d_type == DT_REG)
-                if(regex_match(f->d_name, rx))
-                    results.push_back(path + f->d_name);
-        }
-        closedir(dir);
-    }
+    fileWatcher_.Stop();
+    tokenizedFiles_.Shutdown();
 }
 
 static void GetWidgetNameAndProperties(string line, string &widgetName, string &modifier, string &touchId, bool &isFeedbackInverted, double &holdDelayAmount, bool &isProperty)
@@ -251,24 +1972,11 @@ static void PreProcessZoneFile(string filePath, ControlSurface* surface)
     
     try
     {
-        ifstream file(filePath);
-        
-        for (string line; getline(file, line) ; )
+        for(auto &tokenizedLine : tokenizedFiles_.Get(filePath, true))
         {
-            line = regex_replace(line, regex(TabChars), " ");
-            line = regex_replace(line, regex(CRLFChars), "");
-            
-            line = line.substr(0, line.find("//")); // remove trailing commewnts
-            
-            lineNumber++;
-            
-            // Trim leading and trailing spaces
-            line = regex_replace(line, regex("^\\s+|\\s+$"), "", regex_constants::format_default);
-            
-            if(line == "" || (line.size() > 0 && line[0] == '/')) // ignore blank lines and comment lines
-                continue;
+            lineNumber = tokenizedLine.lineNumber;
             
-            vector<string> tokens(GetTokens(line));
+            const vector<string> &tokens = tokenizedLine.tokens;
             
             if(tokens.size() > 0)
             {
@@ -276,8 +1984,14 @@ static void PreProcessZoneFile(string filePath, ControlSurface* surface)
                 {
                     zoneName = tokens.size() > 1 ? tokens[1] : "";
                     surface->AddZoneFilename(zoneName, filePath);
+                }
+                else if(tokens[0] == "FocusedFXNavigator") // so the Page only sends focus changes to surfaces that can use them
+                {
+                    surface->SetHasFocusedFXZones();
                     break;
                 }
+                else if(tokens[0] == "ZoneEnd")
+                    break;
             }
         }
     }
@@ -289,8 +2003,106 @@ static void PreProcessZoneFile(string filePath, ControlSurface* surface)
     }
 }
 
+static void BuildZoneWidgetTemplates(ZoneTemplate* zoneTemplate, map<string, map<string, vector<ActionTemplate*>>> &widgetActions, map<string, string> &touchIds)
+{
+    for(auto &[widgetName, modifierActions] : widgetActions)
+    {
+        ZoneWidgetTemplate widgetTemplate;
+        widgetTemplate.widgetName = widgetName;
+        
+        string widgetTouchId = touchIds.count(widgetName) > 0 ? touchIds[widgetName] : "";
+        
+        for(auto &[modifier, actions] : modifierActions)
+        {
+            // Modifiers look like FaderTouch+Shift+Alt+, the touch id and flags are matched separately at run time
+            ZoneWidgetTemplate::ModifierActions widgetModifierActions;
+            string touchId = "";
+            
+            istringstream modifierStream(modifier);
+            string modifierToken;
+            
+            while(getline(modifierStream, modifierToken, '+'))
+            {
+                if(modifierToken == Shift)
+                    widgetModifierActions.modifierFlags |= ShiftFlag;
+                else if(modifierToken == Option)
+                    widgetModifierActions.modifierFlags |= OptionFlag;
+                else if(modifierToken == Control)
+                    widgetModifierActions.modifierFlags |= ControlFlag;
+                else if(modifierToken == Alt)
+                    widgetModifierActions.modifierFlags |= AltFlag;
+                else if(modifierToken != "")
+                    touchId = modifierToken;
+            }
+            
+            widgetModifierActions.isTouch = touchId != "";
+            
+            for(auto action : actions)
+            {
+                bool isUsed = ! widgetModifierActions.isTouch || touchId == widgetTouchId; // only the widget's last touch id is ever looked up
+                
+                #ifdef _WIN32
+                // GAW -- This hack is only needed for Mac OS
+                #else
+                // GAW HACK to ensure only SubZone1, SubZone2, SubZone3, etc. get used to trigger GoSubZone
+                if(action->actionName == "GoSubZone" && widgetName.find("SubZone") == string::npos)
+                    isUsed = false;
+                #endif
+                
+                if( ! isUsed)
+                {
+                    delete action;
+                    continue;
+                }
+                
+                // Lines without a channel placeholder resolve their template once and share it across every channel
+                if(action->isChannelInvariant)
+                    action->contextTemplate = TheManager->GetActionContextTemplate(action->actionName, action->params, action->properties, action->isFeedbackInverted, action->holdDelayAmount);
+                
+                widgetModifierActions.actions.push_back(action);
+            }
+            
+            if(widgetModifierActions.actions.size() == 0)
+                continue;
+            
+            widgetModifierActions.firstContext = widgetTemplate.numContexts;
+            widgetTemplate.numContexts += widgetModifierActions.actions.size();
+            widgetTemplate.modifierActions.push_back(widgetModifierActions);
+        }
+        
+        zoneTemplate->widgets.push_back(widgetTemplate);
+    }
+    
+    // Touch ids are <widget>Touch, <widget>TouchPress or <widget>TouchRelease
+    for(auto &widgetTemplate : zoneTemplate->widgets)
+    {
+        if(touchIds.count(widgetTemplate.widgetName) == 0)
+            continue;
+        
+        string touchedWidgetName = touchIds[widgetTemplate.widgetName];
+        
+        for(string suffix : { "TouchRelease", "TouchPress", "Touch" })
+        {
+            if(touchedWidgetName.length() > suffix.length() && touchedWidgetName.compare(touchedWidgetName.length() - suffix.length(), suffix.length(), suffix) == 0)
+            {
+                widgetTemplate.isTouchRelease = suffix == "TouchRelease";
+                touchedWidgetName = touchedWidgetName.substr(0, touchedWidgetName.length() - suffix.length());
+                break;
+            }
+        }
+        
+        for(int i = 0; i < (int)zoneTemplate->widgets.size(); i++)
+            if(zoneTemplate->widgets[i].widgetName == touchedWidgetName)
+                widgetTemplate.touchWidgetIndex = i;
+    }
+}
+
 static void ProcessZoneFile(string filePath, ControlSurface* surface)
 {
+    TraceSpan span("ProcessZoneFile", surface->GetName(), filePath);
+    
+    double parseStartTime = DAW::GetPreciseNumberOfMilliseconds();
+    
     vector<string> includedZones;
     bool isInIncludedZonesSection = false;
     vector<string> subZones;
@@ -310,24 +2122,11 @@ static void ProcessZoneFile(string filePath, ControlSurface* surface)
     
     try
     {
-        ifstream file(filePath);
-        
-        for (string line; getline(file, line) ; )
-        {           
-            line = regex_replace(line, regex(TabChars), " ");
-            line = regex_replace(line, regex(CRLFChars), "");
-            
-            line = line.substr(0, line.find("//")); // remove trailing commewnts
-            
-            lineNumber++;
-            
-            // Trim leading and trailing spaces
-            line = regex_replace(line, regex("^\\s+|\\s+$"), "", regex_constants::format_default);
-            
-            if(line == "" || (line.size() > 0 && line[0] == '/')) // ignore blank lines and comment lines
-                continue;
+        for(auto &tokenizedLine : tokenizedFiles_.Get(filePath, true))
+        {
+            lineNumber = tokenizedLine.lineNumber;
             
-            vector<string> tokens(GetTokens(line));
+            const vector<string> &tokens = tokenizedLine.tokens;
             
             if(tokens.size() > 0)
             {
@@ -410,32 +2209,31 @@ static void ProcessZoneFile(string filePath, ControlSurface* surface)
                         }
                     }
 
-                    for(int i = 0; i < navigators.size(); i++)
+                    // Parsed once, channel Zones only differ by navigator and channel number, which they substitute when first used
+                    ZoneTemplate* zoneTemplate = new ZoneTemplate();
+                    zoneTemplate->name = zoneName;
+                    zoneTemplate->alias = zoneAlias;
+                    zoneTemplate->sourceFilePath = filePath;
+                    zoneTemplate->navigationStyle = navigationStyle;
+                    zoneTemplate->isChannelZone = navigators.size() > 1;
+                    
+                    BuildZoneWidgetTemplates(zoneTemplate, widgetActions, touchIds);
+                    
+                    bool isModifierZone = actionName == Shift || actionName == Option || actionName == Control || actionName == Alt;
+                    
+                    for(int i = 0; i < (int)navigators.size(); i++)
                     {
-                        string numStr = to_string(i + 1);
-                        
                         string newZoneName = zoneName;
                         
-                        map<string, string> expandedTouchIds;
+                        if(zoneTemplate->isChannelZone)
+                            newZoneName += to_string(i + 1);
                         
-                        if(navigators.size() > 1)
-                        {
-                            newZoneName += numStr;
+                        Zone* zone = surface->GetLoadedZone(newZoneName);
                         
-                            for(auto [key, value] : touchIds)
-                            {
-                                string expandedKey = regex_replace(key, regex("[|]"), numStr);
-                                string expandedValue = regex_replace(value, regex("[|]"), numStr);
-
-                                expandedTouchIds[expandedKey] = expandedValue;
-                            }
-                        }
+                        if(zone != nullptr)
+                            zone->Reset(zoneTemplate, navigators[i]);
                         else
-                        {
-                            expandedTouchIds = touchIds;
-                        }
-                        
-                        Zone* zone = new Zone(surface, navigators[i], navigationStyle, i, expandedTouchIds, newZoneName, zoneAlias, filePath);
+                            zone = surface->GetArena().New<Zone>(surface, zoneTemplate, navigators[i], i, newZoneName);
                         
                         for(auto includedZoneName : includedZones)
                         {
@@ -475,63 +2273,16 @@ static void ProcessZoneFile(string filePath, ControlSurface* surface)
                                 zone->AddSubZone(subZone);
                         }
                         
-                        for(auto [widgetName, modifierActions] : widgetActions)
-                        {
-                            string surfaceWidgetName = widgetName;
-                            
-                            if(navigators.size() > 1)
-                                surfaceWidgetName = regex_replace(surfaceWidgetName, regex("[|]"), to_string(i + 1));
-                            
-                            Widget* widget = surface->GetWidgetByName(surfaceWidgetName);
-                            
-                            if(widget == nullptr)
-                                continue;
-                            
-                            if(actionName == Shift || actionName == Option || actionName == Control || actionName == Alt)
+                        // Modifier widgets have to be known before any zone using them resolves
+                        if(isModifierZone)
+                            for(auto widget : zone->GetWidgets())
                                 widget->SetIsModifier();
-                            
-                            zone->AddWidget(widget);
-                            
-                            for(auto [modifier, actions] : modifierActions)
-                            {
-                                for(auto action : actions)
-                                {
-                                    
-                                    
-                                    
-                                    #ifdef _WIN32
-                                    // GAW -- This hack is only needed for Mac OS
-                                    #else
-                                    // GAW HACK to ensure only SubZone1, SubZone2, SubZone3, etc. get used to trigger GoSubZone
-                                    if(action->actionName == "GoSubZone" && widget->GetName().find("SubZone") == string::npos)
-                                        continue;
-                                    #endif
-                                    
-                                    
-                                    
-                                    string actionName = regex_replace(action->actionName, regex("[|]"), numStr);
-                                    vector<string> memberParams;
-                                    for(int j = 0; j < action->params.size(); j++)
-                                        memberParams.push_back(regex_replace(action->params[j], regex("[|]"), numStr));
-                                    
-                                    ActionContext context = TheManager->GetActionContext(actionName, widget, zone, memberParams, action->properties);
-                                                                        
-                                    if(action->isFeedbackInverted)
-                                        context.SetIsFeedbackInverted();
-                                    
-                                    if(action->holdDelayAmount != 0.0)
-                                        context.SetHoldDelayAmount(action->holdDelayAmount);
-                                    
-                                    string expandedModifier = regex_replace(modifier, regex("[|]"), numStr);
-                                    
-                                    zone->AddActionContext(widget, expandedModifier, context);
-                                }
-                            }
-                        }
                         
                         surface->AddZone(zone);
                     }
                     
+                    surface->SetZoneTemplate(zoneTemplate);
+                    
                     includedZones.clear();
                     subZones.clear();
                     widgetActions.clear();
@@ -612,6 +2363,9 @@ static void ProcessZoneFile(string filePath, ControlSurface* surface)
         snprintf(buffer, sizeof(buffer), "Trouble in %s, around line %d\n", filePath.c_str(), lineNumber);
         DAW::ShowConsoleMsg(buffer);
     }
+    
+    surface->GetStats().numZoneFilesParsed++;
+    surface->GetStats().zoneParseMilliseconds += DAW::GetPreciseNumberOfMilliseconds() - parseStartTime;
 }
 
 void SetRGB(vector<string> params, bool &supportsRGB, bool &supportsTrackColor, vector<rgb_color> &RGBValues)
@@ -734,14 +2488,14 @@ static int strToHex(string valueStr)
     return strtol(valueStr.c_str(), nullptr, 16);
 }
 
-static void ProcessMidiWidget(int &lineNumber, ifstream &surfaceTemplateFile, vector<string> tokens,  Midi_ControlSurface* surface)
+static void ProcessMidiWidget(size_t &lineIndex, const TokenizedFile &surfaceTemplateFile, vector<string> tokens,  Midi_ControlSurface* surface)
 {
     if(tokens.size() < 2)
         return;
     
     string widgetName = tokens[1];
 
-    Widget* widget = new Widget(surface, widgetName);
+    Widget* widget = surface->GetArena().New<Widget>(surface, widgetName);
     
     if(! widget)
         return;
@@ -750,17 +2504,9 @@ static void ProcessMidiWidget(int &lineNumber, ifstream &surfaceTemplateFile, ve
 
     vector<vector<string>> tokenLines;
     
-    for (string line; getline(surfaceTemplateFile, line) ; )
+    while(++lineIndex < surfaceTemplateFile.size())
     {
-        line = regex_replace(line, regex(TabChars), " ");
-        line = regex_replace(line, regex(CRLFChars), "");
-
-        lineNumber++;
-        
-        if(line == "" || line[0] == '\r' || line[0] == '/') // ignore comment lines and blank lines
-            continue;
-        
-        vector<string> tokens(GetTokens(line));
+        const vector<string> &tokens = surfaceTemplateFile[lineIndex].tokens;
         
         if(tokens[0] == "WidgetEnd")    // finito baybay - Widget list complete
             break;
@@ -779,127 +2525,129 @@ static void ProcessMidiWidget(int &lineNumber, ifstream &surfaceTemplateFile, ve
 
         // Control Signal Generators
         if(widgetClass == "AnyPress" && (size == 4 || size == 7))
-            new AnyPress_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            surface->GetArena().New<AnyPress_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         if(widgetClass == "Press" && size == 4)
-            new PressRelease_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            surface->GetArena().New<PressRelease_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         else if(widgetClass == "Press" && size == 7)
-            new PressRelease_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), new MIDI_event_ex_t(strToHex(tokenLines[i][4]), strToHex(tokenLines[i][5]), strToHex(tokenLines[i][6])));
+            surface->GetArena().New<PressRelease_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][4]), strToHex(tokenLines[i][5]), strToHex(tokenLines[i][6])));
         else if(widgetClass == "Fader14Bit" && size == 4)
-            new Fader14Bit_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            surface->GetArena().New<Fader14Bit_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         else if(widgetClass == "Fader7Bit" && size== 4)
-            new Fader7Bit_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            surface->GetArena().New<Fader7Bit_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         else if(widgetClass == "Encoder" && size == 4)
-            new Encoder_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            surface->GetArena().New<Encoder_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         else if(widgetClass == "Encoder" && size > 4)
-            new AcceleratedEncoder_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), tokenLines[i]);
+            surface->GetArena().New<AcceleratedEncoder_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), tokenLines[i]);
         else if(widgetClass == "MFTEncoder" && size > 4)
-            new MFT_AcceleratedEncoder_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), tokenLines[i]);
+            surface->GetArena().New<MFT_AcceleratedEncoder_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), tokenLines[i]);
+        else if(widgetClass == "TimeAcceleratedEncoder" && size == 4)
+            surface->GetArena().New<TimeAcceleratedEncoder_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         else if(widgetClass == "EncoderPlain" && size == 4)
-            new EncoderPlain_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            surface->GetArena().New<EncoderPlain_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         else if(widgetClass == "EncoderPlainReverse" && size == 4)
-            new EncoderPlainReverse_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            surface->GetArena().New<EncoderPlainReverse_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         else if(widgetClass == "Touch" && size == 7)
-            new Touch_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), new MIDI_event_ex_t(strToHex(tokenLines[i][4]), strToHex(tokenLines[i][5]), strToHex(tokenLines[i][6])));
+            surface->GetArena().New<Touch_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][4]), strToHex(tokenLines[i][5]), strToHex(tokenLines[i][6])));
         else if(widgetClass == "Toggle" && size == 4)
-            new Toggle_Midi_CSIMessageGenerator(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            surface->GetArena().New<Toggle_Midi_CSIMessageGenerator>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
 
         // Feedback Processors
         FeedbackProcessor* feedbackProcessor = nullptr;
 
         if(widgetClass == "FB_TwoState" && size == 7)
         {
-            feedbackProcessor = new TwoState_Midi_FeedbackProcessor(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), new MIDI_event_ex_t(strToHex(tokenLines[i][4]), strToHex(tokenLines[i][5]), strToHex(tokenLines[i][6])));
+            feedbackProcessor = surface->GetArena().New<TwoState_Midi_FeedbackProcessor>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])), surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][4]), strToHex(tokenLines[i][5]), strToHex(tokenLines[i][6])));
         }
         else if(widgetClass == "FB_NovationLaunchpadMiniRGB7Bit" && size == 4)
         {
-            feedbackProcessor = new NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            feedbackProcessor = surface->GetArena().New<NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         }
         else if(widgetClass == "FB_MFT_RGB" && size == 4)
         {
-            feedbackProcessor = new MFT_RGB_Midi_FeedbackProcessor(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            feedbackProcessor = surface->GetArena().New<MFT_RGB_Midi_FeedbackProcessor>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         }
         else if(widgetClass == "FB_FaderportRGB7Bit" && size == 4)
         {
-            feedbackProcessor = new FaderportRGB7Bit_Midi_FeedbackProcessor(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            feedbackProcessor = surface->GetArena().New<FaderportRGB7Bit_Midi_FeedbackProcessor>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         }
         else if(widgetClass == "FB_Fader14Bit" && size == 4)
         {
-            feedbackProcessor = new Fader14Bit_Midi_FeedbackProcessor(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            feedbackProcessor = surface->GetArena().New<Fader14Bit_Midi_FeedbackProcessor>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         }
         else if(widgetClass == "FB_Fader7Bit" && size == 4)
         {
-            feedbackProcessor = new Fader7Bit_Midi_FeedbackProcessor(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            feedbackProcessor = surface->GetArena().New<Fader7Bit_Midi_FeedbackProcessor>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         }
         else if(widgetClass == "FB_Encoder" && size == 4)
         {
-            feedbackProcessor = new Encoder_Midi_FeedbackProcessor(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            feedbackProcessor = surface->GetArena().New<Encoder_Midi_FeedbackProcessor>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         }
         else if(widgetClass == "FB_VUMeter" && size == 4)
         {
-            feedbackProcessor = new VUMeter_Midi_FeedbackProcessor(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            feedbackProcessor = surface->GetArena().New<VUMeter_Midi_FeedbackProcessor>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         }
         else if(widgetClass == "FB_GainReductionMeter" && size == 4)
         {
-            feedbackProcessor = new GainReductionMeter_Midi_FeedbackProcessor(surface, widget, new MIDI_event_ex_t(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
+            feedbackProcessor = surface->GetArena().New<GainReductionMeter_Midi_FeedbackProcessor>(surface, widget, surface->GetArena().New<MIDI_event_ex_t>(strToHex(tokenLines[i][1]), strToHex(tokenLines[i][2]), strToHex(tokenLines[i][3])));
         }
         else if(widgetClass == "FB_MCUTimeDisplay" && size == 1)
         {
-            feedbackProcessor = new MCU_TimeDisplay_Midi_FeedbackProcessor(surface, widget);
+            feedbackProcessor = surface->GetArena().New<MCU_TimeDisplay_Midi_FeedbackProcessor>(surface, widget);
         }
         else if(widgetClass == "FB_QConProXMasterVUMeter" && size == 2)
         {
-            feedbackProcessor = new QConProXMasterVUMeter_Midi_FeedbackProcessor(surface, widget, stoi(tokenLines[i][1]));
+            feedbackProcessor = surface->GetArena().New<QConProXMasterVUMeter_Midi_FeedbackProcessor>(surface, widget, stoi(tokenLines[i][1]));
         }
         else if((widgetClass == "FB_MCUVUMeter" || widgetClass == "FB_MCUXTVUMeter") && size == 2)
         {
             int displayType = widgetClass == "FB_MCUVUMeter" ? 0x14 : 0x15;
             
-            feedbackProcessor = new MCUVUMeter_Midi_FeedbackProcessor(surface, widget, displayType, stoi(tokenLines[i][1]));
+            feedbackProcessor = surface->GetArena().New<MCUVUMeter_Midi_FeedbackProcessor>(surface, widget, displayType, stoi(tokenLines[i][1]));
             
             surface->SetHasMCUMeters(displayType);
         }
         else if(widgetClass == "FB_SCE24_Text" && size == 3)
         {
-            feedbackProcessor = new SCE24_Text_Midi_FeedbackProcessor(surface, widget, stoi(tokenLines[i][1]), stoi(tokenLines[i][2]));
+            feedbackProcessor = surface->GetArena().New<SCE24_Text_Midi_FeedbackProcessor>(surface, widget, stoi(tokenLines[i][1]), stoi(tokenLines[i][2]));
         }
         else if(widgetClass == "FB_SCE24_Bar" && size == 3)
         {
-            feedbackProcessor = new SCE24_Bar_Midi_FeedbackProcessor(surface, widget, stoi(tokenLines[i][1]), stoi(tokenLines[i][2]));
+            feedbackProcessor = surface->GetArena().New<SCE24_Bar_Midi_FeedbackProcessor>(surface, widget, stoi(tokenLines[i][1]), stoi(tokenLines[i][2]));
         }
         else if(widgetClass == "FB_SCE24_OLEDButton" && size == 3)
         {
-            feedbackProcessor = new SCE24_OLEDButton_Midi_FeedbackProcessor(surface, widget, strToHex(tokenLines[i][1]), stoi(tokenLines[i][2]));
+            feedbackProcessor = surface->GetArena().New<SCE24_OLEDButton_Midi_FeedbackProcessor>(surface, widget, strToHex(tokenLines[i][1]), stoi(tokenLines[i][2]));
         }
         else if(widgetClass == "FB_SCE24_LEDButton" && size == 2)
         {
-            feedbackProcessor = new SCE24_LEDButton_Midi_FeedbackProcessor(surface, widget, strToHex(tokenLines[i][1]));
+            feedbackProcessor = surface->GetArena().New<SCE24_LEDButton_Midi_FeedbackProcessor>(surface, widget, strToHex(tokenLines[i][1]));
         }
         else if(widgetClass == "FB_SCE24_Background" && size == 2)
         {
-            feedbackProcessor = new SCE24_Background_Midi_FeedbackProcessor(surface, widget, strToHex(tokenLines[i][1]));
+            feedbackProcessor = surface->GetArena().New<SCE24_Background_Midi_FeedbackProcessor>(surface, widget, strToHex(tokenLines[i][1]));
         }
         else if(widgetClass == "FB_SCE24_Ring" && size == 2)
         {
-            feedbackProcessor = new SCE24_Ring_Midi_FeedbackProcessor(surface, widget, stoi(tokenLines[i][1]));
+            feedbackProcessor = surface->GetArena().New<SCE24_Ring_Midi_FeedbackProcessor>(surface, widget, stoi(tokenLines[i][1]));
         }
         else if((widgetClass == "FB_MCUDisplayUpper" || widgetClass == "FB_MCUDisplayLower" || widgetClass == "FB_MCUXTDisplayUpper" || widgetClass == "FB_MCUXTDisplayLower") && size == 2)
         {
             if(widgetClass == "FB_MCUDisplayUpper")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(surface, widget, 0, 0x14, 0x12, stoi(tokenLines[i][1]));
+                feedbackProcessor = surface->GetArena().New<MCUDisplay_Midi_FeedbackProcessor>(surface, widget, 0, 0x14, 0x12, stoi(tokenLines[i][1]));
             else if(widgetClass == "FB_MCUDisplayLower")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(surface, widget, 1, 0x14, 0x12, stoi(tokenLines[i][1]));
+                feedbackProcessor = surface->GetArena().New<MCUDisplay_Midi_FeedbackProcessor>(surface, widget, 1, 0x14, 0x12, stoi(tokenLines[i][1]));
             else if(widgetClass == "FB_MCUXTDisplayUpper")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(surface, widget, 0, 0x15, 0x12, stoi(tokenLines[i][1]));
+                feedbackProcessor = surface->GetArena().New<MCUDisplay_Midi_FeedbackProcessor>(surface, widget, 0, 0x15, 0x12, stoi(tokenLines[i][1]));
             else if(widgetClass == "FB_MCUXTDisplayLower")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(surface, widget, 1, 0x15, 0x12, stoi(tokenLines[i][1]));
+                feedbackProcessor = surface->GetArena().New<MCUDisplay_Midi_FeedbackProcessor>(surface, widget, 1, 0x15, 0x12, stoi(tokenLines[i][1]));
         }
         
         else if((widgetClass == "FB_C4DisplayUpper" || widgetClass == "FB_C4DisplayLower") && size == 3)
         {
             if(widgetClass == "FB_C4DisplayUpper")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(surface, widget, 0, 0x17, stoi(tokenLines[i][1]) + 0x30, stoi(tokenLines[i][2]));
+                feedbackProcessor = surface->GetArena().New<MCUDisplay_Midi_FeedbackProcessor>(surface, widget, 0, 0x17, stoi(tokenLines[i][1]) + 0x30, stoi(tokenLines[i][2]));
             else if(widgetClass == "FB_C4DisplayLower")
-                feedbackProcessor = new MCUDisplay_Midi_FeedbackProcessor(surface, widget, 1, 0x17, stoi(tokenLines[i][1]) + 0x30, stoi(tokenLines[i][2]));
+                feedbackProcessor = surface->GetArena().New<MCUDisplay_Midi_FeedbackProcessor>(surface, widget, 1, 0x17, stoi(tokenLines[i][1]) + 0x30, stoi(tokenLines[i][2]));
         }
         
         else if((widgetClass == "FB_FP8Display" || widgetClass == "FB_FP16Display"
@@ -909,34 +2657,34 @@ static void ProcessMidiWidget(int &lineNumber, ifstream &surfaceTemplateFile, ve
                  || widgetClass == "FB_FP8DisplayLower" || widgetClass == "FB_FP16DisplayLower") && size == 2)
         {
             if(widgetClass == "FB_FP8Display" || widgetClass == "FB_FP8DisplayUpper")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(surface, widget, 0x02, stoi(tokenLines[i][1]), 0x00);
+                feedbackProcessor = surface->GetArena().New<FPDisplay_Midi_FeedbackProcessor>(surface, widget, 0x02, stoi(tokenLines[i][1]), 0x00);
             else if(widgetClass == "FB_FP8DisplayUpperMiddle")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(surface, widget, 0x02, stoi(tokenLines[i][1]), 0x01);
+                feedbackProcessor = surface->GetArena().New<FPDisplay_Midi_FeedbackProcessor>(surface, widget, 0x02, stoi(tokenLines[i][1]), 0x01);
             else if(widgetClass == "FB_FP8DisplayLowerMiddle")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(surface, widget, 0x02, stoi(tokenLines[i][1]), 0x02);
+                feedbackProcessor = surface->GetArena().New<FPDisplay_Midi_FeedbackProcessor>(surface, widget, 0x02, stoi(tokenLines[i][1]), 0x02);
             else if(widgetClass == "FB_FP8DisplayLower")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(surface, widget, 0x02, stoi(tokenLines[i][1]), 0x03);
+                feedbackProcessor = surface->GetArena().New<FPDisplay_Midi_FeedbackProcessor>(surface, widget, 0x02, stoi(tokenLines[i][1]), 0x03);
 
             else if(widgetClass == "FB_FP16Display" ||  widgetClass == "FB_FP16DisplayUpper")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(surface, widget, 0x16, stoi(tokenLines[i][1]), 0x00);
+                feedbackProcessor = surface->GetArena().New<FPDisplay_Midi_FeedbackProcessor>(surface, widget, 0x16, stoi(tokenLines[i][1]), 0x00);
             else if(widgetClass == "FB_FP16DisplayUpperMiddle")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(surface, widget, 0x16, stoi(tokenLines[i][1]), 0x01);
+                feedbackProcessor = surface->GetArena().New<FPDisplay_Midi_FeedbackProcessor>(surface, widget, 0x16, stoi(tokenLines[i][1]), 0x01);
             else if(widgetClass == "FB_FP16DisplayLowerMiddle")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(surface, widget, 0x16, stoi(tokenLines[i][1]), 0x02);
+                feedbackProcessor = surface->GetArena().New<FPDisplay_Midi_FeedbackProcessor>(surface, widget, 0x16, stoi(tokenLines[i][1]), 0x02);
             else if(widgetClass == "FB_FP16DisplayLower")
-                feedbackProcessor = new FPDisplay_Midi_FeedbackProcessor(surface, widget, 0x16, stoi(tokenLines[i][1]), 0x03);
+                feedbackProcessor = surface->GetArena().New<FPDisplay_Midi_FeedbackProcessor>(surface, widget, 0x16, stoi(tokenLines[i][1]), 0x03);
         }
         
         else if((widgetClass == "FB_QConLiteDisplayUpper" || widgetClass == "FB_QConLiteDisplayUpperMid" || widgetClass == "FB_QConLiteDisplayLowerMid" || widgetClass == "FB_QConLiteDisplayLower") && size == 2)
         {
             if(widgetClass == "FB_QConLiteDisplayUpper")
-                feedbackProcessor = new QConLiteDisplay_Midi_FeedbackProcessor(surface, widget, 0, 0x14, 0x12, stoi(tokenLines[i][1]));
+                feedbackProcessor = surface->GetArena().New<QConLiteDisplay_Midi_FeedbackProcessor>(surface, widget, 0, 0x14, 0x12, stoi(tokenLines[i][1]));
             else if(widgetClass == "FB_QConLiteDisplayUpperMid")
-                feedbackProcessor = new QConLiteDisplay_Midi_FeedbackProcessor(surface, widget, 1, 0x14, 0x12, stoi(tokenLines[i][1]));
+                feedbackProcessor = surface->GetArena().New<QConLiteDisplay_Midi_FeedbackProcessor>(surface, widget, 1, 0x14, 0x12, stoi(tokenLines[i][1]));
             else if(widgetClass == "FB_QConLiteDisplayLowerMid")
-                feedbackProcessor = new QConLiteDisplay_Midi_FeedbackProcessor(surface, widget, 2, 0x14, 0x12, stoi(tokenLines[i][1]));
+                feedbackProcessor = surface->GetArena().New<QConLiteDisplay_Midi_FeedbackProcessor>(surface, widget, 2, 0x14, 0x12, stoi(tokenLines[i][1]));
             else if(widgetClass == "FB_QConLiteDisplayLower")
-                feedbackProcessor = new QConLiteDisplay_Midi_FeedbackProcessor(surface, widget, 3, 0x14, 0x12, stoi(tokenLines[i][1]));
+                feedbackProcessor = surface->GetArena().New<QConLiteDisplay_Midi_FeedbackProcessor>(surface, widget, 3, 0x14, 0x12, stoi(tokenLines[i][1]));
         }
 
         if(feedbackProcessor != nullptr)
@@ -944,12 +2692,12 @@ static void ProcessMidiWidget(int &lineNumber, ifstream &surfaceTemplateFile, ve
     }
 }
 
-static void ProcessOSCWidget(int &lineNumber, ifstream &surfaceTemplateFile, vector<string> tokens,  OSC_ControlSurface* surface)
+static void ProcessOSCWidget(size_t &lineIndex, const TokenizedFile &surfaceTemplateFile, vector<string> tokens,  OSC_ControlSurface* surface)
 {
     if(tokens.size() < 2)
         return;
     
-    Widget* widget = new Widget(surface, tokens[1]);
+    Widget* widget = surface->GetArena().New<Widget>(surface, tokens[1]);
     
     if(! widget)
         return;
@@ -958,17 +2706,9 @@ static void ProcessOSCWidget(int &lineNumber, ifstream &surfaceTemplateFile, vec
 
     vector<vector<string>> tokenLines;
 
-    for (string line; getline(surfaceTemplateFile, line) ; )
+    while(++lineIndex < surfaceTemplateFile.size())
     {
-        line = regex_replace(line, regex(TabChars), " ");
-        line = regex_replace(line, regex(CRLFChars), "");
-
-        lineNumber++;
-        
-        if(line == "" || line[0] == '\r' || line[0] == '/') // ignore comment lines and blank lines
-            continue;
-        
-        vector<string> tokens(GetTokens(line));
+        const vector<string> &tokens = surfaceTemplateFile[lineIndex].tokens;
         
         if(tokens[0] == "WidgetEnd")    // finito baybay - Widget list complete
             break;
@@ -979,11 +2719,26 @@ static void ProcessOSCWidget(int &lineNumber, ifstream &surfaceTemplateFile, vec
     for(auto tokenLine : tokenLines)
     {
         if(tokenLine.size() > 1 && tokenLine[0] == "Control")
-            new CSIMessageGenerator(surface, widget, tokenLine[1]);
+            surface->GetArena().New<CSIMessageGenerator>(surface, widget, tokenLine[1]);
+        else if(tokenLine.size() > 1 && tokenLine[0] == "Press")
+        {
+            // Same as Control, but the widget is a button, so its presses are never coalesced
+            widget->SetIsPress();
+            surface->GetArena().New<CSIMessageGenerator>(surface, widget, tokenLine[1]);
+        }
         else if(tokenLine.size() > 1 && tokenLine[0] == "Touch")
-            new Touch_CSIMessageGenerator(surface, widget, tokenLine[1]);
+            surface->GetArena().New<Touch_CSIMessageGenerator>(surface, widget, tokenLine[1]);
         else if(tokenLine.size() > 1 && tokenLine[0] == "FB_Processor")
-            widget->AddFeedbackProcessor(new OSC_FeedbackProcessor(surface, widget, tokenLine[1]));
+        {
+            OSCColorFormat colorFormat = OSCColorSeparate;
+            
+            if(tokenLine.size() > 2 && tokenLine[2] == "ColorInts")
+                colorFormat = OSCColorInts;
+            else if(tokenLine.size() > 2 && tokenLine[2] == "ColorRGBA")
+                colorFormat = OSCColorRGBA;
+            
+            widget->AddFeedbackProcessor(surface->GetArena().New<OSC_FeedbackProcessor>(surface, widget, tokenLine[1], colorFormat));
+        }
     }
 }
 
@@ -993,26 +2748,20 @@ static void ProcessWidgetFile(string filePath, ControlSurface* surface)
     
     try
     {
-        ifstream file(filePath);
+        const TokenizedFile &file = tokenizedFiles_.Get(filePath, false);
         
-        for (string line; getline(file, line) ; )
+        for(size_t lineIndex = 0; lineIndex < file.size(); lineIndex++)
         {
-            line = regex_replace(line, regex(TabChars), " ");
-            line = regex_replace(line, regex(CRLFChars), "");
-            
-            lineNumber++;
+            lineNumber = file[lineIndex].lineNumber;
             
-            if(line == "" || line[0] == '\r' || line[0] == '/') // ignore comment lines and blank lines
-                continue;
-            
-            vector<string> tokens(GetTokens(line));
+            const vector<string> &tokens = file[lineIndex].tokens;
             
             if(tokens.size() > 0 && tokens[0] == "Widget")
             {
                 if(filePath[filePath.length() - 3] == 'm')
-                    ProcessMidiWidget(lineNumber, file, tokens, (Midi_ControlSurface*)surface);
+                    ProcessMidiWidget(lineIndex, file, tokens, (Midi_ControlSurface*)surface);
                 if(filePath[filePath.length() - 3] == 'o')
-                    ProcessOSCWidget(lineNumber, file, tokens, (OSC_ControlSurface*)surface);
+                    ProcessOSCWidget(lineIndex, file, tokens, (OSC_ControlSurface*)surface);
             }
         }
     }
@@ -1027,6 +2776,349 @@ static void ProcessWidgetFile(string filePath, ControlSurface* surface)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Manager
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+static oscpkt::UdpSocket* statsQuerySocket_ = nullptr;
+static int statsQueryPort_ = 0;
+
+const size_t StatsReplyChunkSize = 8000; // keeps each reply datagram under the 9216 byte default limit on macOS
+
+static void AppendJSONValue(string &output, const char* key, unsigned long long value)
+{
+    output += string(",\"") + key + "\":" + to_string(value);
+}
+
+string Manager::GetStatsJSON()
+{
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.3f", DAW::GetPreciseNumberOfMilliseconds());
+    
+    string json = string("{\"timestamp\":") + buffer + ",\"surfaces\":[";
+    
+    bool isFirst = true;
+    
+    for(auto page : pages_)
+    {
+        for(auto surface : page->GetSurfaces())
+        {
+            SurfaceStats &stats = surface->GetStats();
+            
+            json += isFirst ? "\n{\"page\":" : ",\n{\"page\":";
+            isFirst = false;
+            
+            AppendJSONString(json, page->GetName().c_str());
+            json += ",\"surface\":";
+            AppendJSONString(json, surface->GetName().c_str());
+            json += string(",\"online\":") + (surface->GetIsOnline() ? "true" : "false");
+            AppendJSONValue(json, "messagesReceived", stats.numMessagesReceived);
+            AppendJSONValue(json, "messagesDispatched", stats.numMessagesDispatched);
+            AppendJSONValue(json, "messagesUnmapped", stats.numMessagesUnmapped);
+            AppendJSONValue(json, "messagesSent", stats.numMessagesSent);
+            AppendJSONValue(json, "bytesSent", stats.numBytesSent);
+            AppendJSONValue(json, "feedbackDedupeHits", surface->GetNumFeedbackDedupeHits());
+            AppendJSONValue(json, "deviceStateHits", stats.numDeviceStateHits);
+            AppendJSONValue(json, "feedbackDropped", stats.numMessagesDropped);
+            AppendJSONValue(json, "inputQueueDepth", surface->GetInputQueueDepth());
+            AppendJSONValue(json, "droppedMessages", surface->GetNumDroppedMessages());
+            AppendJSONValue(json, "overflowedRuns", surface->GetNumOverflowedRuns());
+            AppendJSONValue(json, "zoneActivations", stats.numZoneActivations);
+            AppendJSONValue(json, "zoneFilesParsed", stats.numZoneFilesParsed);
+            snprintf(buffer, sizeof(buffer), ",\"zoneParseMilliseconds\":%.3f}", stats.zoneParseMilliseconds);
+            json += buffer;
+        }
+    }
+    
+    json += "],\n\"midiOutputPorts\":[";
+    isFirst = true;
+    
+    for(auto [port, output] : midiOutputs_)
+    {
+        json += string(isFirst ? "\n" : ",\n") + "{\"port\":" + to_string(port);
+        isFirst = false;
+        
+        AppendJSONValue(json, "messagesSent", output->stats_.numMessagesSent);
+        AppendJSONValue(json, "bytesSent", output->stats_.numBytesSent);
+        
+        if(output->queue_ != nullptr)
+        {
+            AppendJSONValue(json, "outputQueueDepth", output->queue_->GetSize());
+            AppendJSONValue(json, "droppedMessages", output->queue_->GetNumDropped() + output->numDropped_);
+            AppendJSONValue(json, "bytesPerSecond", output->bytesPerSecond_);
+            AppendJSONValue(json, "waitingMessages", output->numWaiting_);
+            AppendJSONValue(json, "replacedMessages", output->numReplaced_);
+        }
+        
+        json += "}";
+    }
+    
+    json += "],\n\"oscOutputSockets\":[";
+    isFirst = true;
+    
+    for(auto [key, stats] : outputSocketStats_)
+    {
+        json += string(isFirst ? "\n" : ",\n") + "{\"socket\":";
+        isFirst = false;
+        
+        AppendJSONString(json, key.c_str());
+        AppendJSONValue(json, "messagesSent", stats.numMessagesSent);
+        AppendJSONValue(json, "bytesSent", stats.numBytesSent);
+        json += "}";
+    }
+    
+    json += "]}\n";
+    
+    return json;
+}
+
+void Manager::WriteStatsSnapshot()
+{
+    string filePath = string(DAW::GetResourcePath()) + "/CSI/CSI_stats.json";
+    
+    ofstream statsFile(filePath, ios::trunc);
+    
+    if(statsFile.is_open())
+    {
+        statsFile << GetStatsJSON();
+        DAW::ShowConsoleMsg(("CSI statistics written to " + filePath + "\n").c_str());
+    }
+}
+
+// Any message to /csi/stats on the StatsQueryPort, from this machine, gets the snapshot back
+// as /csi/stats chunkIndex numChunks text datagrams, join the text of chunks 0 to numChunks - 1
+void Manager::AnswerStatsQueries()
+{
+    if(statsQuerySocket_ == nullptr || ! statsQuerySocket_->isOk())
+        return;
+    
+    while(statsQuerySocket_->receiveNextPacket(0))
+    {
+        oscpkt::PacketReader packetReader(statsQuerySocket_->packetData(), statsQuerySocket_->packetSize());
+        oscpkt::Message *message;
+        bool isQueried = false;
+        
+        while (packetReader.isOk() && (message = packetReader.popMessage()) != 0)
+            if(message->addressPattern() == "/csi/stats")
+                isQueried = true;
+        
+        if(isQueried)
+        {
+            string json = GetStatsJSON();
+            int numChunks = (int)((json.size() + StatsReplyChunkSize - 1) / StatsReplyChunkSize);
+            
+            for(int i = 0; i < numChunks; i++)
+            {
+                oscpkt::Message reply("/csi/stats");
+                reply.pushInt32(i);
+                reply.pushInt32(numChunks);
+                reply.pushStr(json.substr(i * StatsReplyChunkSize, StatsReplyChunkSize));
+                
+                oscpkt::PacketWriter packetWriter;
+                packetWriter.addMessage(reply);
+                statsQuerySocket_->sendPacketTo(packetWriter.packetData(), packetWriter.packetSize(), statsQuerySocket_->packetOrigin());
+            }
+        }
+    }
+}
+
+string BenchmarkRunner::GetJSON()
+{
+    string json = "{\"benchmarks\":[";
+    
+    for(size_t i = 0; i < currentIndex_; i++)
+    {
+        Benchmark &benchmark = benchmarks_[i];
+        double nanosecondsPerIteration = benchmark.elapsed * 1000000.0 / benchmark.numIterations;
+        char buffer[256];
+        
+        json += i == 0 ? "\n{\"name\":" : ",\n{\"name\":";
+        AppendJSONString(json, benchmark.name.c_str());
+        
+        if(benchmark.group != "")
+        {
+            json += ",\"group\":";
+            AppendJSONString(json, benchmark.group.c_str());
+        }
+        
+        snprintf(buffer, sizeof(buffer), ",\"iterations\":%lld,\"ns_per_iteration\":%.1f,\"items_per_iteration\":%lld,\"ns_per_item\":%.2f}", benchmark.numIterations, nanosecondsPerIteration, benchmark.itemsPerIteration, benchmark.itemsPerIteration > 0 ? nanosecondsPerIteration / benchmark.itemsPerIteration : 0.0);
+        json += buffer;
+    }
+    
+    json += "\n]}\n";
+    
+    return json;
+}
+
+
+// Only the paths that leave no trace in the project or on the hardware, against whatever is loaded right now,
+// each benchmark holds its own copy of what it works on since it runs over many Runs
+void Manager::AddBenchmarks(BenchmarkRunner &runner)
+{
+    vector<Midi_ControlSurface*> midiSurfaces;
+    vector<ControlSurface*> surfaces;
+    set<string> zoneFiles;
+    
+    if(pages_.size() > 0)
+    {
+        for(auto surface : pages_[currentPageIndex_]->GetSurfaces())
+        {
+            if( ! surface->GetIsOnline())
+                continue;
+            
+            surfaces.push_back(surface);
+            
+            if(Midi_ControlSurface* midiSurface = dynamic_cast<Midi_ControlSurface*>(surface))
+                midiSurfaces.push_back(midiSurface);
+            
+            for(auto zone : surface->GetZones())
+                zoneFiles.insert(zone->GetSourceFilePath());
+        }
+    }
+    
+    // MIDI dispatch, every mapped message plus as many unmapped ones
+    for(auto surface : midiSurfaces)
+    {
+        vector<int> messages;
+        surface->GetMappedMessages(messages);
+        
+        auto events = make_shared<vector<MIDI_event_ex_t>>();
+        
+        for(auto message : messages)
+        {
+            events->push_back(MIDI_event_ex_t((message >> 16) & 0xff, (message >> 8) & 0xff, message & 0xff));
+            events->push_back(MIDI_event_ex_t(0xa0 | ((message >> 16) & 0x0f), (message >> 8) & 0xff, message & 0xff)); // the same on poly pressure, which templates rarely map
+        }
+        
+        if(events->size() > 0)
+            runner.AddBenchmark("MidiDispatchLookup/" + surface->GetName(), events->size(), [surface, events]()
+            {
+                static int numFound = 0;
+                
+                for(auto &event : *events)
+                    if(surface->GetMessageGenerators(&event) != nullptr)
+                        numFound++;
+            });
+    }
+    
+    // Zone::GetActionContexts for every widget each loaded zone maps, with the page's modifiers as they are when it runs
+    for(auto surface : surfaces)
+    {
+        auto lookups = make_shared<vector<pair<Zone*, Widget*>>>();
+        
+        for(auto zone : surface->GetZones())
+            for(auto widget : zone->GetWidgets())
+                lookups->push_back(make_pair(zone, widget));
+        
+        if(lookups->size() > 0)
+            runner.AddBenchmark("ZoneGetActionContexts/" + surface->GetName(), lookups->size(), [lookups]()
+            {
+                static size_t numContexts = 0;
+                
+                for(auto &[zone, widget] : *lookups)
+                    numContexts += zone->GetActionContexts(widget).size();
+            });
+    }
+    
+    // Zone file tokenizing, the part of ProcessZoneFile that doesn't touch the surface
+    for(auto zoneFile : zoneFiles)
+    {
+        auto tokenizedFile = make_shared<TokenizedFile>();
+        TokenizeFile(zoneFile, true, *tokenizedFile);
+        
+        runner.AddBenchmark("TokenizeZoneFile/" + zoneFile.substr(zoneFile.find_last_of("/\\") + 1), tokenizedFile->size(), [zoneFile, tokenizedFile]()
+        {
+            tokenizedFile->clear();
+            TokenizeFile(zoneFile, true, *tokenizedFile);
+        });
+    }
+    
+    // OSC feedback encode and input decode, as done per message by OSC_ControlSurface
+    auto packetWriter = make_shared<oscpkt::PacketWriter>();
+    
+    runner.AddBenchmark("OSCEncodeFloat", 1, [packetWriter]()
+    {
+        oscpkt::Message message;
+        message.init("/Track/1/Volume").pushFloat(0.5);
+        packetWriter->init().addMessage(message);
+    });
+    
+    oscpkt::PacketWriter packetWriterForDecode;
+    packetWriterForDecode.init().addMessage(oscpkt::Message("/Track/1/Volume").pushFloat(0.5));
+    string packet((const char*)packetWriterForDecode.packetData(), packetWriterForDecode.packetSize());
+    auto packetReader = make_shared<oscpkt::PacketReader>();
+    
+    runner.AddBenchmark("OSCDecodeFloat", 1, [packetReader, packet]()
+    {
+        static float decoded = 0.0;
+        
+        packetReader->init(packet.data(), packet.size());
+        oscpkt::Message *message;
+        
+        while (packetReader->isOk() && (message = packetReader->popMessage()) != 0)
+            if(message->arg().isFloat())
+                message->arg().popFloat(decoded);
+    });
+}
+
+// The results are written once the last benchmark is done, a reset before then abandons them
+void Manager::RunBenchmarks()
+{
+    if(benchmarkRunner_ != nullptr)
+    {
+        DAW::ShowConsoleMsg("CSI benchmarks are already running\n");
+        return;
+    }
+    
+    benchmarkRunner_ = new BenchmarkRunner(200.0);
+    AddBenchmarks(*benchmarkRunner_);
+    
+    DAW::ShowConsoleMsg("CSI benchmarks started, they run alongside the surfaces for a few seconds\n");
+}
+
+void Manager::RunBenchmarkSlice()
+{
+    benchmarkRunner_->Run(BenchmarkSliceMilliseconds);
+    
+    if( ! benchmarkRunner_->GetIsDone())
+        return;
+    
+    string filePath = string(DAW::GetResourcePath()) + "/CSI/CSI_benchmark.json";
+    ofstream benchmarkFile(filePath, ios::trunc);
+    
+    if(benchmarkFile.is_open())
+    {
+        benchmarkFile << benchmarkRunner_->GetJSON();
+        DAW::ShowConsoleMsg(("CSI benchmark results written to " + filePath + "\n").c_str());
+    }
+    
+    delete benchmarkRunner_;
+    benchmarkRunner_ = nullptr;
+}
+
+void Manager::ReloadChangedFiles()
+{
+    vector<string> changedFiles;
+    fileWatcher_.GetChangedFiles(changedFiles);
+    
+    bool isSurfaceTemplateChanged = false;
+    
+    for(auto filePath : changedFiles)
+    {
+        tokenizedFiles_.Forget(filePath);
+        
+        if(filePath.length() > 4 && filePath.substr(filePath.length() - 4) == ".zon")
+        {
+            for(auto page : pages_)
+                page->ReloadZoneFile(filePath);
+        }
+        else if(filePath.length() > 4 && (filePath.substr(filePath.length() - 4) == ".mst" || filePath.substr(filePath.length() - 4) == ".ost"))
+            isSurfaceTemplateChanged = true;
+        
+        if(surfaceInDisplay_)
+            DAW::ShowConsoleMsg(("Reloaded " + filePath + "\n").c_str());
+    }
+    
+    if(isSurfaceTemplateChanged) // widgets are referenced from everywhere, rebuild the surfaces as a reset would
+        Init();
+}
+
 void Manager::InitActionsDictionary()
 {    
     actions_["TrackAutoMode"] =                     new TrackAutoMode();
@@ -1171,10 +3263,25 @@ void Manager::InitActionsDictionary()
 
 void Manager::Init()
 {
+    if(benchmarkRunner_ != nullptr) // they hold on to surfaces this may delete
+    {
+        delete benchmarkRunner_;
+        benchmarkRunner_ = nullptr;
+        DAW::ShowConsoleMsg("CSI benchmarks abandoned, the surfaces were reset\n");
+    }
+    
+    // Pages and surfaces whose CSI.ini lines and files are unchanged are kept running, everything else is torn down and rebuilt
+    keptSurfacesToCheck_.clear();
+    
+    vector<Page*> previousPages = pages_;
+    vector<string> previousPageConfigs = pageConfigs_;
+    
     pages_.clear();
-
-    Page* currentPage = nullptr;
+    pageConfigs_.clear();
     
+    shouldRefreshInactivePages_ = GetCSIOption("InactivePageRefresh");
+    feedbackWorkers_.Start(max(0, min(GetCSIOptionValue("FeedbackWorkers"), MaxFeedbackWorkers)));
+
     string iniFilePath = string(DAW::GetResourcePath()) + "/CSI/CSI.ini";
     
     int lineNumber = 0;
@@ -1184,6 +3291,10 @@ void Manager::Init()
         ifstream iniFile(iniFilePath);
         
         int numChannels = 0;
+        
+        vector<string> widgetFiles;
+        vector<string> zoneFolders;
+        vector<vector<string>> configLines;
     
         for (string line; getline(iniFile, line) ; )
         {
@@ -1194,59 +3305,188 @@ void Manager::Init()
             
             if(tokens.size() > 4) // ignore comment lines and blank lines
             {
+                configLines.push_back(tokens);
+                
                 if(tokens[0] == MidiSurfaceToken && tokens.size() == 10)
                 {
                     if(atoi(tokens[6].c_str()) + atoi(tokens[9].c_str()) > numChannels )
                         numChannels = atoi(tokens[6].c_str()) + atoi(tokens[9].c_str());
+                    
+                    widgetFiles.push_back(string(DAW::GetResourcePath()) + "/CSI/Surfaces/Midi/" + tokens[4]);
+                    zoneFolders.push_back(DAW::GetResourcePath() + string("/CSI/Zones/") + tokens[5] + "/");
                 }
                 else if(tokens[0] == OSCSurfaceToken && tokens.size() == 11)
                 {
                     if(atoi(tokens[6].c_str()) + atoi(tokens[9].c_str()) > numChannels )
                         numChannels = atoi(tokens[6].c_str()) + atoi(tokens[9].c_str());
+                    
+                    widgetFiles.push_back(string(DAW::GetResourcePath()) + "/CSI/Surfaces/OSC/" + tokens[4]);
+                    zoneFolders.push_back(DAW::GetResourcePath() + string("/CSI/Zones/") + tokens[5] + "/");
                 }
             }
         }
         
-        iniFile.clear();
-        iniFile.seekg(0);
+        // A page's config is its own line and the channel count its navigators were built for,
+        // a surface's config is its own line and I/O threading, each survives a reset while unchanged.
+        // Whether a kept surface's files changed is only known once the workers have read them again, see CheckKeptSurfaces
+        vector<string> pageConfigs;
+        vector<vector<string>> pageLines;
+        vector<vector<vector<string>>> surfaceLines;
+        vector<vector<string>> surfaceConfigs;
+        set<int> midiInputPorts;
+        set<int> midiOutputPorts;
+        set<string> oscInputSockets;
+        set<string> oscOutputSockets;
         
-        for (string line; getline(iniFile, line) ; )
+        for(auto &tokens : configLines)
         {
-            line = regex_replace(line, regex(TabChars), " ");
-            line = regex_replace(line, regex(CRLFChars), "");
+            if(tokens[0] == PageToken && tokens.size() == 5)
+            {
+                string pageConfig = to_string(numChannels);
+                
+                for(auto &token : tokens)
+                    pageConfig += "\x1f" + token;
+                
+                pageConfigs.push_back(pageConfig);
+                pageLines.push_back(tokens);
+                surfaceLines.push_back(vector<vector<string>>());
+                surfaceConfigs.push_back(vector<string>());
+            }
+            else if(pageLines.size() > 0 && ((tokens[0] == MidiSurfaceToken && tokens.size() == 10) || (tokens[0] == OSCSurfaceToken && tokens.size() == 11)))
+            {
+                string surfaceConfig = "";
+                
+                for(auto &token : tokens)
+                    surfaceConfig += "\x1f" + token;
+                
+                if(tokens[0] == MidiSurfaceToken)
+                {
+                    midiInputPorts.insert(atoi(tokens[2].c_str()));
+                    midiOutputPorts.insert(atoi(tokens[3].c_str()));
+                    
+                    // A surface picks its I/O threads when it's built, so a change there rebuilds it
+                    surfaceConfig += string("\x1d") + (GetCSIOption("MidiInputThread") ? "1" : "0") + (GetIsMidiOutputThreaded(atoi(tokens[3].c_str())) ? "1" : "0");
+                }
+                else
+                {
+                    oscInputSockets.insert(GetInputSocketKey(tokens[1], atoi(tokens[2].c_str())));
+                    oscOutputSockets.insert(GetOutputSocketKey(tokens[1], tokens[10], atoi(tokens[3].c_str())));
+                    
+                    surfaceConfig += string("\x1d") + (GetCSIOption("OSCInputThread") ? "1" : "0");
+                }
+                
+                surfaceLines.back().push_back(tokens);
+                surfaceConfigs.back().push_back(surfaceConfig);
+            }
+        }
+        
+        // Unchanged surfaces of unchanged pages are kept running, their slots are filled in below
+        vector<vector<ControlSurface*>> keptSurfaces;
+        
+        for(size_t i = 0; i < pageConfigs.size(); i++)
+        {
+            Page* page = nullptr;
             
-            vector<string> tokens(GetTokens(line));
+            for(size_t j = 0; j < previousPages.size(); j++)
+            {
+                if(previousPages[j] != nullptr && previousPageConfigs[j] == pageConfigs[i])
+                {
+                    page = previousPages[j];
+                    previousPages[j] = nullptr;
+                    break;
+                }
+            }
+            
+            keptSurfaces.push_back(page != nullptr ? page->KeepSurfaces(surfaceConfigs[i]) : vector<ControlSurface*>(surfaceConfigs[i].size(), nullptr));
+            
+            for(auto surface : keptSurfaces.back())
+                if(surface != nullptr && surface->GetIsOnline())
+                    keptSurfacesToCheck_.push_back(surface);
+            
+            pages_.push_back(page);
+            pageConfigs_.push_back(pageConfigs[i]);
+        }
+        
+        // Removed and changed pages and surfaces go first, they give back the ports before unused ones are closed
+        for(auto page : previousPages)
+            delete page;
+        
+        previousPages.clear();
+        
+        ReleaseUnusedIO(midiInputPorts, midiOutputPorts, oscInputSockets, oscOutputSockets);
+        
+        // Surfaces are only created here, the files they need are read in the background and they come online in Run
+        sort(zoneFolders.begin(), zoneFolders.end());
+        zoneFolders.erase(unique(zoneFolders.begin(), zoneFolders.end()), zoneFolders.end());
+        
+        tokenizedFiles_.Clear();
+        tokenizedFiles_.Prefetch(widgetFiles, zoneFolders);
+        
+        isWatchingFiles_ = GetCSIOption("ZoneHotReload");
+        
+        int statsQueryPort = GetCSIOptionValue("StatsQueryPort");
+        
+        if(statsQueryPort != statsQueryPort_)
+        {
+            delete statsQuerySocket_;
+            statsQuerySocket_ = nullptr;
+            statsQueryPort_ = statsQueryPort;
+            
+            if(statsQueryPort_ > 0)
+            {
+                statsQuerySocket_ = new oscpkt::UdpSocket();
+                statsQuerySocket_->bindTo("127.0.0.1", statsQueryPort_); // the snapshot names every surface and port, so it's never offered to the network
+            }
+        }
+        
+        isAnsweringStatsQueries_ = statsQuerySocket_ != nullptr && statsQuerySocket_->isOk();
+        
+        traceLog_.SetLogFilePath(GetCSIOption("TraceLogFile") ? string(DAW::GetResourcePath()) + "/CSI/CSI.log" : "");
+        
+        if(isWatchingFiles_)
+            fileWatcher_.Start({ DAW::GetResourcePath() + string("/CSI/Zones/"), DAW::GetResourcePath() + string("/CSI/Surfaces/") });
+        else
+            fileWatcher_.Stop();
+        
+        for(size_t i = 0; i < pages_.size(); i++)
+        {
+            if(pages_[i] == nullptr)
+            {
+                const vector<string> &tokens = pageLines[i];
+                pages_[i] = new Page(tokens[1], tokens[2] == "FollowMCP" ? true : false, tokens[3] == "SynchPages" ? true : false, tokens[4] == "UseScrollLink" ? true : false, numChannels);
+            }
+            
+            Page* currentPage = pages_[i];
             
-            if(tokens.size() > 4) // ignore comment lines and blank lines
+            for(size_t j = 0; j < surfaceLines[i].size(); j++)
             {
-                if(tokens[0] == PageToken)
-                {
-                    if(tokens.size() != 5)
-                        continue;
-
-                    currentPage = new Page(tokens[1], tokens[2] == "FollowMCP" ? true : false, tokens[3] == "SynchPages" ? true : false, tokens[4] == "UseScrollLink" ? true : false, numChannels);
-                    pages_.push_back(currentPage);
-                }
-                else if(tokens[0] == MidiSurfaceToken || tokens[0] == OSCSurfaceToken)
+                ControlSurface* surface = keptSurfaces[i][j];
+                
+                if(surface == nullptr)
                 {
-                    int inPort = 0;
-                    int outPort = 0;
+                    const vector<string> &tokens = surfaceLines[i][j];
                     
-                    inPort = atoi(tokens[2].c_str());
-                    outPort = atoi(tokens[3].c_str());
+                    int inPort = atoi(tokens[2].c_str());
+                    int outPort = atoi(tokens[3].c_str());
                     
-                    if(currentPage)
+                    if(tokens[0] == MidiSurfaceToken)
                     {
-                        ControlSurface* surface = nullptr;
+                        midi_Input* midiInput = GetMidiInputForPort(inPort); // must exist before the port's input queue is requested
+                        midi_Output* midiOutput = GetMidiOutputForPort(outPort); // likewise for the port's device state
                         
-                        if(tokens[0] == MidiSurfaceToken && tokens.size() == 10)
-                            surface = new Midi_ControlSurface(CSurfIntegrator_, currentPage, tokens[1], tokens[4], tokens[5], atoi(tokens[6].c_str()), atoi(tokens[7].c_str()), atoi(tokens[8].c_str()), atoi(tokens[9].c_str()), GetMidiInputForPort(inPort), GetMidiOutputForPort(outPort));
-                        else if(tokens[0] == OSCSurfaceToken && tokens.size() == 11)
-                            surface = new OSC_ControlSurface(CSurfIntegrator_, currentPage, tokens[1], tokens[4], tokens[5], atoi(tokens[6].c_str()), atoi(tokens[7].c_str()), atoi(tokens[8].c_str()), atoi(tokens[9].c_str()), GetInputSocketForPort(tokens[1], inPort), GetOutputSocketForAddressAndPort(tokens[1], tokens[10], outPort));
-
-                        currentPage->AddSurface(surface);
+                        surface = new Midi_ControlSurface(CSurfIntegrator_, currentPage, tokens[1], tokens[4], tokens[5], atoi(tokens[6].c_str()), atoi(tokens[7].c_str()), atoi(tokens[8].c_str()), atoi(tokens[9].c_str()), midiInput, midiOutput, GetMidiInputQueueForPort(inPort), GetMidiOutputQueueForPort(outPort), GetMidiDeviceStateForPort(outPort));
+                        surface->SetOutputPortStats(GetMidiOutputStatsForPort(outPort));
+                    }
+                    else
+                    {
+                        oscpkt::UdpSocket* inSocket = GetInputSocketForPort(tokens[1], inPort); // must exist before the surface's input queue is requested
+                        
+                        surface = new OSC_ControlSurface(CSurfIntegrator_, currentPage, tokens[1], tokens[4], tokens[5], atoi(tokens[6].c_str()), atoi(tokens[7].c_str()), atoi(tokens[8].c_str()), atoi(tokens[9].c_str()), inSocket, GetOutputSocketForAddressAndPort(tokens[1], tokens[10], outPort), GetOSCInputQueueForSurface(tokens[1], inPort));
+                        surface->SetOutputPortStats(GetOutputSocketStats(tokens[1], tokens[10], outPort));
                     }
                 }
+                
+                currentPage->AddSurface(surface, surfaceConfigs[i][j]);
             }
         }
         
@@ -1286,9 +3526,8 @@ void Manager::Init()
         snprintf(buffer, sizeof(buffer), "Trouble in %s, around line %d\n", iniFilePath.c_str(), lineNumber);
         DAW::ShowConsoleMsg(buffer);
     }
-      
-    for(auto page : pages_)
-        page->OnInitialization();
+
+    hasOfflineSurfaces_ = true;
 }
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Parsing end
@@ -1364,19 +3603,20 @@ MediaTrack* FocusedFXNavigator::GetTrack()
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ActionContext
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-ActionContext::ActionContext(Action* action, Widget* widget, Zone* zone, vector<string> params, vector<vector<string>> properties): action_(action), widget_(widget), zone_(zone), properties_(properties)
-{   
+// holdDelayAmount is specified in seconds, the template keeps it in milliseconds
+ActionContextTemplate::ActionContextTemplate(Action* action, vector<string> params, vector<vector<string>> properties, bool isFeedbackInverted, double holdDelayAmount) : action(action), isFeedbackInverted(isFeedbackInverted), holdDelayAmount(holdDelayAmount * 1000.0), properties(properties)
+{
     for(auto property : properties)
     {
         if(property.size() == 0)
             continue;
 
         if(property[0] == "NoFeedback")
-            noFeedback_ = true;
+            noFeedback = true;
+        else if(property[0] == "Coalesce")
+            shouldCoalesce = true;
     }
     
-    widget->SetProperties(properties);
-    
     string actionName = "";
     
     if(params.size() > 0)
@@ -1385,86 +3625,94 @@ ActionContext::ActionContext(Action* action, Widget* widget, Zone* zone, vector<
     // Action with int param, could include leading minus sign
     if(params.size() > 1 && (isdigit(params[1][0]) ||  params[1][0] == '-'))  // C++ 11 says empty strings can be queried without catastrophe :)
     {
-        intParam_= atol(params[1].c_str());
+        intParam= atol(params[1].c_str());
     }
     
     // Action with param index, must be positive
     if(params.size() > 1 && isdigit(params[1][0]))  // C++ 11 says empty strings can be queried without catastrophe :)
     {
-        paramIndex_ = atol(params[1].c_str());
+        paramIndex = atol(params[1].c_str());
     }
     
     // Action with string param
     if(params.size() > 1)
-        stringParam_ = params[1];
+        stringParam = params[1];
     
     if(actionName == "TrackVolumeDB" || actionName == "TrackSendVolumeDB")
     {
-        rangeMinimum_ = -144.0;
-        rangeMaximum_ = 24.0;
+        rangeMinimum = -144.0;
+        rangeMaximum = 24.0;
     }
     
     if(actionName == "TrackPanPercent" || actionName == "TrackPanWidthPercent" || actionName == "TrackPanLPercent" || actionName == "TrackPanRPercent")
     {
-        rangeMinimum_ = -100.0;
-        rangeMaximum_ = 100.0;
+        rangeMinimum = -100.0;
+        rangeMaximum = 100.0;
     }
    
     if(actionName == "Reaper" && params.size() > 1)
     {
         if (isdigit(params[1][0]))
         {
-            commandId_ =  atol(params[1].c_str());
+            commandId =  atol(params[1].c_str());
         }
         else // look up by string
         {
-            commandId_ = DAW::NamedCommandLookup(params[1].c_str());
+            commandId = DAW::NamedCommandLookup(params[1].c_str());
             
-            if(commandId_ == 0) // can't find it
-                commandId_ = 65535; // no-op
+            if(commandId == 0) // can't find it
+                commandId = 65535; // no-op
         }
     }
     
     if(actionName == "FXParam" && params.size() > 1 && isdigit(params[1][0])) // C++ 11 says empty strings can be queried without catastrophe :)
     {
-        paramIndex_ = atol(params[1].c_str());
+        paramIndex = atol(params[1].c_str());
     }
     
     if(actionName == "FXParamValueDisplay" && params.size() > 1 && isdigit(params[1][0]))
     {
-        paramIndex_ = atol(params[1].c_str());
+        paramIndex = atol(params[1].c_str());
         
         if(params.size() > 2 && params[2] != "[" && params[2] != "{" && isdigit(params[2][0]))
         {
-            shouldUseDisplayStyle_ = true;
-            displayStyle_ = atol(params[2].c_str());
+            shouldUseDisplayStyle = true;
+            displayStyle = atol(params[2].c_str());
         }
     }
     
     if(actionName == "FXParamNameDisplay" && params.size() > 1 && isdigit(params[1][0]))
     {
-        paramIndex_ = atol(params[1].c_str());
+        paramIndex = atol(params[1].c_str());
         
         if(params.size() > 2 && params[2] != "{" && params[2] != "[")
-            fxParamDisplayName_ = params[2];
+            fxParamDisplayName = params[2];
     }
     
     if(actionName == "MCUTrackPanDisplay"&& params.size() > 1)
     {
-        SetAssociatedWidget(GetSurface()->GetWidgetByName(params[1]));
+        associatedWidgetName = params[1];
     }
     
     if(params.size() > 0)
     {
-        SetRGB(params, supportsRGB_, supportsTrackColor_, RGBValues_);
-        SetSteppedValues(params, deltaValue_, acceleratedDeltaValues_, rangeMinimum_, rangeMaximum_, steppedValues_, acceleratedTickValues_);
+        SetRGB(params, supportsRGB, supportsTrackColor, RGBValues);
+        SetSteppedValues(params, deltaValue, acceleratedDeltaValues, rangeMinimum, rangeMaximum, steppedValues, acceleratedTickValues);
     }
     
-    if(acceleratedTickValues_.size() < 1)
-        acceleratedTickValues_.push_back(10);
+    if(acceleratedTickValues.size() < 1)
+        acceleratedTickValues.push_back(10);
 
 }
 
+ActionContext::ActionContext(const ActionContextTemplate* contextTemplate, Widget* widget, Zone* zone) : contextTemplate_(contextTemplate), widget_(widget), zone_(zone)
+{
+    widget->SetProperties(contextTemplate->properties);
+    
+    if(contextTemplate->associatedWidgetName != "")
+        SetAssociatedWidget(GetSurface()->GetWidgetByName(contextTemplate->associatedWidgetName));
+}
+
 Page* ActionContext::GetPage()
 {
     return widget_->GetSurface()->GetPage();
@@ -1485,14 +3733,14 @@ int ActionContext::GetSlotIndex()
     return zone_->GetSlotIndex();
 }
 
-string ActionContext::GetName()
+const string &ActionContext::GetName()
 {
     return zone_->GetNameOrAlias();
 }
 
 void ActionContext::RunDeferredActions()
 {
-    if(holdDelayAmount_ != 0.0 && delayStartTime_ != 0.0 && DAW::GetCurrentNumberOfMilliseconds() > (delayStartTime_ + holdDelayAmount_))
+    if(contextTemplate_->holdDelayAmount != 0.0 && delayStartTime_ != 0.0 && DAW::GetCurrentNumberOfMilliseconds() > (delayStartTime_ + contextTemplate_->holdDelayAmount))
     {
         DoRangeBoundAction(deferredValue_);
         
@@ -1503,10 +3751,10 @@ void ActionContext::RunDeferredActions()
 
 void ActionContext::RequestUpdate()
 {
-    if(noFeedback_)
+    if(contextTemplate_->noFeedback)
         return;
     
-    action_->RequestUpdate(this);
+    contextTemplate_->action->RequestUpdate(this);
 }
 
 void ActionContext::ClearWidget()
@@ -1514,103 +3762,161 @@ void ActionContext::ClearWidget()
     widget_->Clear();
 }
 
+bool ActionContext::GetTrackColor(rgb_color &color)
+{
+    if(MediaTrack* track = zone_->GetNavigator()->GetTrack())
+    {
+        unsigned int* rgb_colour = (unsigned int*)DAW::GetSetMediaTrackInfo(track, "I_CUSTOMCOLOR", NULL);
+        
+        color.r = (*rgb_colour >> 0) & 0xff;
+        color.g = (*rgb_colour >> 8) & 0xff;
+        color.b = (*rgb_colour >> 16) & 0xff;
+        
+        return true;
+    }
+    
+    return false;
+}
+
+// Applied straight away, or held as a snapshot with everything it needs from REAPER while the surface takes them
+void ActionContext::UpdateWidget(FeedbackKind kind, int param, double value)
+{
+    FeedbackSnapshot snapshot(widget_, this, kind, param, value);
+    
+    bool isShownAsValue = kind == FeedbackValue || kind == FeedbackParamValue || kind == FeedbackVolume || kind == FeedbackVolumeDB;
+    
+    if(isShownAsValue && contextTemplate_->supportsTrackColor && ! contextTemplate_->supportsRGB)
+        snapshot.hasTrackColor = GetTrackColor(snapshot.trackColor);
+    
+    if(GetSurface()->GetShouldSnapshotFeedback(widget_))
+        GetSurface()->AddFeedbackSnapshot(snapshot);
+    else
+        ApplyFeedback(snapshot, nullptr, 0);
+}
+
 void ActionContext::UpdateWidgetValue(double value)
 {
-    if(steppedValues_.size() > 0)
-        SetSteppedValueIndex(value);
+    UpdateWidget(FeedbackValue, 0, value);
+}
 
-    value = isFeedbackInverted_ == false ? value : 1.0 - value;
-   
-    widget_->UpdateValue(value);
+void ActionContext::UpdateWidgetValue(int param, double value)
+{
+    UpdateWidget(FeedbackParamValue, param, value);
+}
+
+void ActionContext::UpdateWidgetValue(const string &value)
+{
+    if(GetSurface()->GetShouldSnapshotFeedback(widget_))
+        GetSurface()->AddFeedbackSnapshot(FeedbackSnapshot(widget_, this, FeedbackText), value.c_str(), (int)value.size());
+    else
+        widget_->UpdateValue(value);
+}
 
-    if(supportsRGB_)
+void ActionContext::UpdateWidgetValue(const char* value)
+{
+    if(GetSurface()->GetShouldSnapshotFeedback(widget_))
+        GetSurface()->AddFeedbackSnapshot(FeedbackSnapshot(widget_, this, FeedbackText), value, (int)strlen(value));
+    else
     {
-        currentRGBIndex_ = value == 0 ? 0 : 1;
-        widget_->UpdateRGBValue(RGBValues_[currentRGBIndex_].r, RGBValues_[currentRGBIndex_].g, RGBValues_[currentRGBIndex_].b);
+        string &displayText = GetSurface()->GetDisplayText();
+        displayText = value;
+        widget_->UpdateValue(displayText);
     }
-    else if(supportsTrackColor_)
+}
+
+// Everything from here on is the surface's own state, so a feedback worker can run it
+void ActionContext::ApplyFeedback(const FeedbackSnapshot &snapshot, const char* text, int textSize)
+{
+    string &displayText = GetSurface()->GetDisplayText();
+    char buffer[128];
+    
+    switch(snapshot.kind)
     {
-        if(MediaTrack* track = zone_->GetNavigator()->GetTrack())
-        {
-            unsigned int* rgb_colour = (unsigned int*)DAW::GetSetMediaTrackInfo(track, "I_CUSTOMCOLOR", NULL);
+        case FeedbackText:
+            displayText.assign(text, textSize);
+            widget_->UpdateValue(displayText);
+            break;
             
-            int r = (*rgb_colour >> 0) & 0xff;
-            int g = (*rgb_colour >> 8) & 0xff;
-            int b = (*rgb_colour >> 16) & 0xff;
+        case FeedbackVolumeText:
+            snprintf(buffer, sizeof(buffer), "%7.2lf", VAL2DB(snapshot.value));
+            displayText = buffer;
+            widget_->UpdateValue(displayText);
+            break;
             
-            widget_->UpdateRGBValue(r, g, b);
-        }
+        case FeedbackPanText:
+            GetPanValueString(snapshot.value, buffer, sizeof(buffer));
+            displayText = buffer;
+            widget_->UpdateValue(displayText);
+            break;
+            
+        case FeedbackPanWidthText:
+            GetPanWidthValueString(snapshot.value, buffer, sizeof(buffer));
+            displayText = buffer;
+            widget_->UpdateValue(displayText);
+            break;
+            
+        case FeedbackVolume:
+            ApplyWidgetValue(snapshot, volToNormalized(snapshot.value));
+            break;
+            
+        case FeedbackVolumeDB:
+            ApplyWidgetValue(snapshot, VAL2DB(snapshot.value));
+            break;
+            
+        default:
+            ApplyWidgetValue(snapshot, snapshot.value);
     }
 }
 
-void ActionContext::UpdateWidgetValue(int param, double value)
+void ActionContext::ApplyWidgetValue(const FeedbackSnapshot &snapshot, double value)
 {
-    if(steppedValues_.size() > 0)
+    if(contextTemplate_->steppedValues.size() > 0)
         SetSteppedValueIndex(value);
 
-    value = isFeedbackInverted_ == false ? value : 1.0 - value;
-        
-    widget_->UpdateValue(param, value);
-    
-    currentRGBIndex_ = value == 0 ? 0 : 1;
-    
-    if(supportsRGB_)
+    value = contextTemplate_->isFeedbackInverted == false ? value : 1.0 - value;
+   
+    if(snapshot.kind == FeedbackParamValue)
     {
+        widget_->UpdateValue(snapshot.param, value);
         currentRGBIndex_ = value == 0 ? 0 : 1;
-        widget_->UpdateRGBValue(RGBValues_[currentRGBIndex_].r, RGBValues_[currentRGBIndex_].g, RGBValues_[currentRGBIndex_].b);
     }
-    else if(supportsTrackColor_)
+    else
+        widget_->UpdateValue(value);
+
+    if(contextTemplate_->supportsRGB)
     {
-        if(MediaTrack* track = zone_->GetNavigator()->GetTrack())
-        {
-            unsigned int* rgb_colour = (unsigned int*)DAW::GetSetMediaTrackInfo(track, "I_CUSTOMCOLOR", NULL);
-            
-            int r = (*rgb_colour >> 0) & 0xff;
-            int g = (*rgb_colour >> 8) & 0xff;
-            int b = (*rgb_colour >> 16) & 0xff;
-            
-            widget_->UpdateRGBValue(r, g, b);
-        }
+        currentRGBIndex_ = value == 0 ? 0 : 1;
+        const rgb_color &color = contextTemplate_->RGBValues[currentRGBIndex_];
+        widget_->UpdateRGBValue(color.r, color.g, color.b);
     }
-}
-
-void ActionContext::UpdateWidgetValue(string value)
-{
-    widget_->UpdateValue(value);
+    else if(snapshot.hasTrackColor)
+        widget_->UpdateRGBValue(snapshot.trackColor.r, snapshot.trackColor.g, snapshot.trackColor.b);
 }
 
 void ActionContext::ForceWidgetValue(double value)
 {
-    if(steppedValues_.size() > 0)
+    if(contextTemplate_->steppedValues.size() > 0)
         SetSteppedValueIndex(value);
     
-    value = isFeedbackInverted_ == false ? value : 1.0 - value;
+    value = contextTemplate_->isFeedbackInverted == false ? value : 1.0 - value;
     
     widget_->ForceValue(value);
 
-    if(supportsRGB_)
+    rgb_color trackColor;
+    
+    if(contextTemplate_->supportsRGB)
     {
         currentRGBIndex_ = value == 0 ? 0 : 1;
-        widget_->ForceRGBValue(RGBValues_[currentRGBIndex_].r, RGBValues_[currentRGBIndex_].g, RGBValues_[currentRGBIndex_].b);
-    }
-    else if(supportsTrackColor_)
-    {
-        if(MediaTrack* track = zone_->GetNavigator()->GetTrack())
-        {
-            unsigned int* rgb_colour = (unsigned int*)DAW::GetSetMediaTrackInfo(track, "I_CUSTOMCOLOR", NULL);
-            
-            int r = (*rgb_colour >> 0) & 0xff;
-            int g = (*rgb_colour >> 8) & 0xff;
-            int b = (*rgb_colour >> 16) & 0xff;
-            
-            widget_->ForceRGBValue(r, g, b);
-        }
+        const rgb_color &color = contextTemplate_->RGBValues[currentRGBIndex_];
+        widget_->ForceRGBValue(color.r, color.g, color.b);
     }
+    else if(contextTemplate_->supportsTrackColor && GetTrackColor(trackColor))
+        widget_->ForceRGBValue(trackColor.r, trackColor.g, trackColor.b);
 }
 
 void ActionContext::DoAction(double value)
 {
-    if(holdDelayAmount_ != 0.0)
+    if(contextTemplate_->holdDelayAmount != 0.0)
     {
         if(value == 0.0)
         {
@@ -1625,19 +3931,19 @@ void ActionContext::DoAction(double value)
     }
     else
     {
-        if(steppedValues_.size() > 0)
+        if(contextTemplate_->steppedValues.size() > 0)
         {
             if(value != 0.0) // ignore release messages
             {
-                if(steppedValuesIndex_ == steppedValues_.size() - 1)
+                if(steppedValuesIndex_ == (int)contextTemplate_->steppedValues.size() - 1)
                 {
-                    if(steppedValues_[0] < steppedValues_[steppedValuesIndex_]) // GAW -- only wrap if 1st value is lower
+                    if(contextTemplate_->steppedValues[0] < contextTemplate_->steppedValues[steppedValuesIndex_]) // GAW -- only wrap if 1st value is lower
                         steppedValuesIndex_ = 0;
                 }
                 else
                     steppedValuesIndex_++;
                 
-                DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+                DoRangeBoundAction(contextTemplate_->steppedValues[steppedValuesIndex_]);
             }
         }
         else
@@ -1647,43 +3953,112 @@ void ActionContext::DoAction(double value)
 
 void ActionContext::DoRelativeAction(double delta)
 {
-    if(steppedValues_.size() > 0)
+    if(contextTemplate_->steppedValues.size() > 0)
         DoSteppedValueAction(delta);
     else
-        DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) + delta);
+        DoRangeBoundAction(contextTemplate_->action->GetCurrentNormalizedValue(this) + delta);
 }
 
 void ActionContext::DoRelativeAction(int accelerationIndex, double delta)
 {
-    if(steppedValues_.size() > 0)
+    if(contextTemplate_->steppedValues.size() > 0)
         DoAcceleratedSteppedValueAction(accelerationIndex, delta);
-    else if(acceleratedDeltaValues_.size() > 0)
+    else if(contextTemplate_->acceleratedDeltaValues.size() > 0)
         DoAcceleratedDeltaValueAction(accelerationIndex, delta);
     else
-        DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) + delta);
+        DoRangeBoundAction(contextTemplate_->action->GetCurrentNormalizedValue(this) + delta);
+}
+
+// Coalesced variants -- a whole frame's worth of deltas for one widget lands in a single Do()
+void ActionContext::DoRelativeAction(const vector<double> &deltas)
+{
+    if(deltas.size() == 0)
+        return;
+    
+    if(contextTemplate_->steppedValues.size() > 0)
+    {
+        // Stepped values move one step per tick, regardless of the delta size
+        for(auto delta : deltas)
+            MoveSteppedValueIndex(delta);
+        
+        DoRangeBoundAction(contextTemplate_->steppedValues[steppedValuesIndex_]);
+    }
+    else
+    {
+        double delta = 0.0;
+        
+        for(auto value : deltas)
+            delta += value;
+        
+        DoRangeBoundAction(contextTemplate_->action->GetCurrentNormalizedValue(this) + delta);
+    }
+}
+
+void ActionContext::DoRelativeAction(const vector<QueuedAcceleratedRelativeAction> &acceleratedDeltas)
+{
+    if(acceleratedDeltas.size() == 0)
+        return;
+    
+    if(contextTemplate_->steppedValues.size() > 0)
+    {
+        bool hasMoved = false;
+        
+        for(auto acceleratedDelta : acceleratedDeltas)
+        {
+            if(AccumulateAcceleratedTicks(acceleratedDelta.index, acceleratedDelta.delta))
+            {
+                MoveSteppedValueIndex(acceleratedDelta.delta);
+                hasMoved = true;
+            }
+        }
+        
+        if(hasMoved)
+            DoRangeBoundAction(contextTemplate_->steppedValues[steppedValuesIndex_]);
+    }
+    else
+    {
+        double delta = 0.0;
+        
+        for(auto acceleratedDelta : acceleratedDeltas)
+        {
+            if(contextTemplate_->acceleratedDeltaValues.size() > 0)
+            {
+                int accelerationIndex = acceleratedDelta.index;
+                accelerationIndex = accelerationIndex > (int)contextTemplate_->acceleratedDeltaValues.size() - 1 ? (int)contextTemplate_->acceleratedDeltaValues.size() - 1 : accelerationIndex;
+                accelerationIndex = accelerationIndex < 0 ? 0 : accelerationIndex;
+                
+                if(acceleratedDelta.delta > 0.0)
+                    delta += contextTemplate_->acceleratedDeltaValues[accelerationIndex];
+                else
+                    delta -= contextTemplate_->acceleratedDeltaValues[accelerationIndex];
+            }
+            else
+                delta += acceleratedDelta.delta;
+        }
+        
+        DoRangeBoundAction(contextTemplate_->action->GetCurrentNormalizedValue(this) + delta);
+    }
 }
 
 void ActionContext::DoRangeBoundAction(double value)
 {
-    if(value > rangeMaximum_)
-        value = rangeMaximum_;
+    if(value > contextTemplate_->rangeMaximum)
+        value = contextTemplate_->rangeMaximum;
     
-    if(value < rangeMinimum_)
-        value = rangeMinimum_;
+    if(value < contextTemplate_->rangeMinimum)
+        value = contextTemplate_->rangeMinimum;
     
-    action_->Do(this, value);
+    contextTemplate_->action->Do(this, value);
 }
 
-void ActionContext::DoSteppedValueAction(double delta)
+void ActionContext::MoveSteppedValueIndex(double delta)
 {
     if(delta > 0)
     {
         steppedValuesIndex_++;
         
-        if(steppedValuesIndex_ > steppedValues_.size() - 1)
-            steppedValuesIndex_ = steppedValues_.size() - 1;
-        
-        DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+        if(steppedValuesIndex_ > (int)contextTemplate_->steppedValues.size() - 1)
+            steppedValuesIndex_ = (int)contextTemplate_->steppedValues.size() - 1;
     }
     else
     {
@@ -1691,12 +4066,10 @@ void ActionContext::DoSteppedValueAction(double delta)
         
         if(steppedValuesIndex_ < 0 )
             steppedValuesIndex_ = 0;
-        
-        DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
     }
 }
 
-void ActionContext::DoAcceleratedSteppedValueAction(int accelerationIndex, double delta)
+bool ActionContext::AccumulateAcceleratedTicks(int accelerationIndex, double delta)
 {
     if(delta > 0)
     {
@@ -1709,44 +4082,46 @@ void ActionContext::DoAcceleratedSteppedValueAction(int accelerationIndex, doubl
         accumulatedIncTicks_ = accumulatedIncTicks_ - 1 < 0 ? 0 : accumulatedIncTicks_ - 1;
     }
     
-    accelerationIndex = accelerationIndex > acceleratedTickValues_.size() - 1 ? acceleratedTickValues_.size() - 1 : accelerationIndex;
+    accelerationIndex = accelerationIndex > (int)contextTemplate_->acceleratedTickValues.size() - 1 ? (int)contextTemplate_->acceleratedTickValues.size() - 1 : accelerationIndex;
     accelerationIndex = accelerationIndex < 0 ? 0 : accelerationIndex;
     
-    if(delta > 0 && accumulatedIncTicks_ >= acceleratedTickValues_[accelerationIndex])
+    if((delta > 0 && accumulatedIncTicks_ >= contextTemplate_->acceleratedTickValues[accelerationIndex]) || (delta < 0 && accumulatedDecTicks_ >= contextTemplate_->acceleratedTickValues[accelerationIndex]))
     {
         accumulatedIncTicks_ = 0;
         accumulatedDecTicks_ = 0;
         
-        steppedValuesIndex_++;
-        
-        if(steppedValuesIndex_ > steppedValues_.size() - 1)
-            steppedValuesIndex_ = steppedValues_.size() - 1;
-        
-        DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+        return true;
     }
-    else if(delta < 0 && accumulatedDecTicks_ >= acceleratedTickValues_[accelerationIndex])
+    
+    return false;
+}
+
+void ActionContext::DoSteppedValueAction(double delta)
+{
+    MoveSteppedValueIndex(delta);
+    
+    DoRangeBoundAction(contextTemplate_->steppedValues[steppedValuesIndex_]);
+}
+
+void ActionContext::DoAcceleratedSteppedValueAction(int accelerationIndex, double delta)
+{
+    if(AccumulateAcceleratedTicks(accelerationIndex, delta))
     {
-        accumulatedIncTicks_ = 0;
-        accumulatedDecTicks_ = 0;
-        
-        steppedValuesIndex_--;
-        
-        if(steppedValuesIndex_ < 0 )
-            steppedValuesIndex_ = 0;
+        MoveSteppedValueIndex(delta);
         
-        DoRangeBoundAction(steppedValues_[steppedValuesIndex_]);
+        DoRangeBoundAction(contextTemplate_->steppedValues[steppedValuesIndex_]);
     }
 }
 
 void ActionContext::DoAcceleratedDeltaValueAction(int accelerationIndex, double delta)
 {
-    accelerationIndex = accelerationIndex > acceleratedDeltaValues_.size() - 1 ? acceleratedDeltaValues_.size() - 1 : accelerationIndex;
+    accelerationIndex = accelerationIndex > (int)contextTemplate_->acceleratedDeltaValues.size() - 1 ? (int)contextTemplate_->acceleratedDeltaValues.size() - 1 : accelerationIndex;
     accelerationIndex = accelerationIndex < 0 ? 0 : accelerationIndex;
     
     if(delta > 0.0)
-        DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) + acceleratedDeltaValues_[accelerationIndex]);
+        DoRangeBoundAction(contextTemplate_->action->GetCurrentNormalizedValue(this) + contextTemplate_->acceleratedDeltaValues[accelerationIndex]);
     else
-        DoRangeBoundAction(action_->GetCurrentNormalizedValue(this) - acceleratedDeltaValues_[accelerationIndex]);
+        DoRangeBoundAction(contextTemplate_->action->GetCurrentNormalizedValue(this) - contextTemplate_->acceleratedDeltaValues[accelerationIndex]);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1776,41 +4151,136 @@ void Zone::Activate(vector<Zone*> *activeZones)
 
 void Zone::Deactivate()
 {
-    for(auto widget : widgets_)
+    for(auto widget : GetWidgets())
         widget->Clear();
 }
 
-vector<ActionContext>& Zone::GetActionContexts(Widget* widget)
+void Zone::Resolve()
 {
-    string widgetName = widget->GetName();
-    string modifier = "";
+    if(isResolved_)
+        return;
     
-    if( ! widget->GetIsModifier())
-        modifier = surface_->GetPage()->GetModifier();
+    isResolved_ = true;
     
-    if(touchIds_.count(widgetName) > 0 && activeTouchIds_.count(touchIds_[widgetName]) > 0 && activeTouchIds_[touchIds_[widgetName]] == true && actionContextDictionary_[widget].count(touchIds_[widgetName] + "+" + modifier) > 0)
-        return actionContextDictionary_[widget][touchIds_[widgetName] + "+" + modifier];
-    else if(actionContextDictionary_[widget].count(modifier) > 0)
-        return actionContextDictionary_[widget][modifier];
-    else if(actionContextDictionary_[widget].count("") > 0)
-        return actionContextDictionary_[widget][""];
-    else
-        return defaultContexts_;
+    string numStr = to_string(channel_ + 1);
+    
+    const vector<ZoneWidgetTemplate> &widgetTemplates = zoneTemplate_->widgets;
+    
+    touchStates_.assign(widgetTemplates.size(), -1);
+    
+    int numContexts = 0;
+    
+    for(int i = 0; i < (int)widgetTemplates.size(); i++)
+    {
+        Widget* widget = surface_->GetWidgetByName(zoneTemplate_->isChannelZone ? ExpandChannelNumber(widgetTemplates[i].widgetName, numStr) : widgetTemplates[i].widgetName);
+        
+        if(widget == nullptr)
+            continue;
+        
+        widgets_.push_back(widget);
+        widgetTemplateIndices_.push_back(i);
+        widgetFirstContexts_.push_back(numContexts);
+        numContexts += widgetTemplates[i].numContexts;
+    }
+    
+    actionContexts_.reserve(numContexts);
+    
+    for(int i = 0; i < (int)widgets_.size(); i++)
+    {
+        for(auto &modifierActions : widgetTemplates[widgetTemplateIndices_[i]].modifierActions)
+        {
+            for(auto action : modifierActions.actions)
+            {
+                const ActionContextTemplate* contextTemplate = action->contextTemplate;
+                
+                if(contextTemplate == nullptr) // carries the channel placeholder
+                {
+                    vector<string> memberParams;
+                    for(auto &param : action->params)
+                        memberParams.push_back(ExpandChannelNumber(param, numStr));
+                    
+                    contextTemplate = TheManager->GetActionContextTemplate(ExpandChannelNumber(action->actionName, numStr), memberParams, action->properties, action->isFeedbackInverted, action->holdDelayAmount);
+                }
+                
+                actionContexts_.push_back(ActionContext(contextTemplate, widgets_[i], this));
+            }
+        }
+    }
+}
+
+ActionContexts Zone::GetActionContexts(Widget* widget)
+{
+    Resolve();
+    
+    int index = GetWidgetIndex(widget);
+    
+    if(index < 0)
+        return ActionContexts();
+    
+    const ZoneWidgetTemplate &widgetTemplate = zoneTemplate_->widgets[widgetTemplateIndices_[index]];
+    
+    int modifierFlags = widget->GetIsModifier() ? 0 : surface_->GetPage()->GetModifierFlags();
+    
+    bool isTouched = false;
+    
+    if(widgetTemplate.touchWidgetIndex >= 0)
+    {
+        signed char touchState = touchStates_[widgetTemplate.touchWidgetIndex];
+        isTouched = widgetTemplate.isTouchRelease ? touchState == 0 : touchState == 1;
+    }
+    
+    // Touch actions for these modifiers first, then these modifiers, then no modifiers
+    const ZoneWidgetTemplate::ModifierActions* match = nullptr;
+    const ZoneWidgetTemplate::ModifierActions* unmodified = nullptr;
+    
+    for(auto &modifierActions : widgetTemplate.modifierActions)
+    {
+        if(modifierActions.isTouch)
+        {
+            if(isTouched && modifierActions.modifierFlags == modifierFlags)
+            {
+                match = &modifierActions;
+                break;
+            }
+        }
+        else if(modifierActions.modifierFlags == modifierFlags)
+        {
+            if( ! isTouched)
+            {
+                match = &modifierActions;
+                break;
+            }
+            else if(match == nullptr)
+                match = &modifierActions;
+        }
+        else if(modifierActions.modifierFlags == 0)
+            unmodified = &modifierActions;
+    }
+    
+    if(match == nullptr)
+        match = unmodified;
+    
+    if(match == nullptr)
+        return ActionContexts();
+    
+    return ActionContexts(actionContexts_.data() + widgetFirstContexts_[index] + match->firstContext, match->actions.size());
 }
 
 int Zone::GetSlotIndex()
 {
-    if(navigationStyle_ == Standard)
+    NavigationStyle navigationStyle = zoneTemplate_->navigationStyle;
+    
+    if(navigationStyle == Standard)
         return slotIndex_;
-    else if(navigationStyle_ == SendSlot)
+    else if(navigationStyle == SendSlot)
         return surface_->GetPage()->GetSendSlot();
-    else if(navigationStyle_ == ReceiveSlot)
+    else if(navigationStyle == ReceiveSlot)
         return surface_->GetPage()->GetReceiveSlot();
-    else if(navigationStyle_ == FXMenuSlot)
+    else if(navigationStyle == FXMenuSlot)
         return surface_->GetPage()->GetFXMenuSlot();
-    else if(navigationStyle_ == SelectedTrackSendSlot)
+    else if(navigationStyle == SelectedTrackSendSlot)
         return slotIndex_ + surface_->GetPage()->GetSendSlot();
-    else if(navigationStyle_ == SelectedTrackReceiveSlot)
+    else if(navigationStyle == SelectedTrackReceiveSlot)
         return slotIndex_ + surface_->GetPage()->GetReceiveSlot();
     else
         return 0;
@@ -1822,14 +4292,13 @@ void Zone::RequestUpdateWidget(Widget* widget)
     
     // GAW TBD -- This is where we might cut loose multiple feedback if we can individually control it
     
-    for(auto &context : GetActionContexts(widget))
+    ActionContexts contexts = GetActionContexts(widget);
+    
+    for(auto &context : contexts)
         context.RunDeferredActions();
     
-    if(GetActionContexts(widget).size() > 0)
-    {
-        ActionContext& context = GetActionContexts(widget)[0];
-        context.RequestUpdate();
-    }
+    if(contexts.size() > 0)
+        contexts[0].RequestUpdate();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1837,15 +4306,6 @@ void Zone::RequestUpdateWidget(Widget* widget)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 Widget::Widget(ControlSurface* surface, string name) : surface_(surface), name_(name) {}
 
-Widget::~Widget()
-{
-    for(auto feedbackProcessor :feedbackProcessors_)
-    {
-        delete feedbackProcessor;
-        feedbackProcessor = nullptr;
-    }
-};
-
 
 void Widget::HandleQueuedActions(Zone* zone)
 {
@@ -1874,18 +4334,59 @@ void Widget::HandleQueuedActions(Zone* zone)
 
     WDL_mutex.Leave();
     
-
-    for(auto value : queuedActionValues)
-        zone->DoAction(this, value);
+    if(queuedActionValues.size() > 0)
+    {
+        hasIncomingValue_ = true;
+        lastIncomingValue_ = queuedActionValues.back();
+    }
+    
+    // Coalescing follows whichever context currently drives the widget, so it changes with the zone and modifier
+    bool shouldCoalesce = false;
+    
+    if(queuedActionValues.size() > 0 || queuedRelativeActionValues.size() > 0 || queuedAcceleratedRelativeActionValues.size() > 0)
+    {
+        ActionContexts contexts = zone->GetActionContexts(this);
+        shouldCoalesce = contexts.size() > 0 && contexts[0].GetShouldCoalesce();
+    }
+    
+    if(shouldCoalesce)
+    {
+        // Absolute values collapse to the latest one, presses are never merged
+        if(isPress_)
+        {
+            for(auto value : queuedActionValues)
+                zone->DoAction(this, value);
+        }
+        else if(queuedActionValues.size() > 0)
+            zone->DoAction(this, queuedActionValues.back());
+        
+        if(queuedRelativeActionValues.size() > 0)
+            zone->DoRelativeAction(this, queuedRelativeActionValues);
         
-    for(auto delta : queuedRelativeActionValues)
-        zone->DoRelativeAction(this, delta);
-     
-    for(auto acceleratedRelativeAction : queuedAcceleratedRelativeActionValues)
-        zone->DoRelativeAction(this, acceleratedRelativeAction.index, acceleratedRelativeAction.delta);
+        if(queuedAcceleratedRelativeActionValues.size() > 0)
+            zone->DoRelativeAction(this, queuedAcceleratedRelativeActionValues);
+    }
+    else
+    {
+        for(auto value : queuedActionValues)
+            zone->DoAction(this, value);
+            
+        for(auto delta : queuedRelativeActionValues)
+            zone->DoRelativeAction(this, delta);
+         
+        for(auto acceleratedRelativeAction : queuedAcceleratedRelativeActionValues)
+            zone->DoRelativeAction(this, acceleratedRelativeAction.index, acceleratedRelativeAction.delta);
+    }
 
     for(auto value : queuedTouchActionValues)
-        zone->DoTouch(this, name_, value);
+    {
+        if(isTouched_ && value == 0)
+            shouldResyncFeedback_ = true; // released, send the DAW value no matter what
+        
+        isTouched_ = value != 0;
+        
+        zone->DoTouch(this, value);
+    }
 }
 
 void Widget::QueueAction(double value)
@@ -1924,6 +4425,14 @@ void Widget::QueueTouch(double value)
     WDL_mutex.Leave();
 }
 
+void Widget::AddFeedbackProcessor(FeedbackProcessor* feedbackProcessor)
+{
+    feedbackProcessors_.push_back(feedbackProcessor);
+    
+    if(feedbackProcessor->GetIsReadingDAW())
+        isReadingDAW_ = true;
+}
+
 void Widget::SetProperties(vector<vector<string>> properties)
 {
     for(auto processor : feedbackProcessors_)
@@ -1934,15 +4443,19 @@ void  Widget::UpdateValue(double value)
 {
     for(auto processor : feedbackProcessors_)
         processor->SetValue(value);
+    
+    shouldResyncFeedback_ = false;
 }
 
 void  Widget::UpdateValue(int mode, double value)
 {
     for(auto processor : feedbackProcessors_)
         processor->SetValue(mode, value);
+    
+    shouldResyncFeedback_ = false;
 }
 
-void  Widget::UpdateValue(string value)
+void  Widget::UpdateValue(const string &value)
 {
     for(auto processor : feedbackProcessors_)
         processor->SetValue(value);
@@ -1968,14 +4481,30 @@ void  Widget::ForceRGBValue(int r, int g, int b)
 
 void  Widget::Clear()
 {
-    for(auto processor : feedbackProcessors_)
-        processor->Clear();
+    if(surface_->GetShouldSnapshotFeedback(this))
+        surface_->AddFeedbackSnapshot(FeedbackSnapshot(this, nullptr, FeedbackClear));
+    else
+        for(auto processor : feedbackProcessors_)
+            processor->Clear();
 }
 
 void  Widget::ForceClear()
 {
+    if(surface_->GetShouldSnapshotFeedback(this))
+        surface_->AddFeedbackSnapshot(FeedbackSnapshot(this, nullptr, FeedbackForceClear));
+    else
+        for(auto processor : feedbackProcessors_)
+            processor->ForceClear();
+}
+
+unsigned long long Widget::GetNumFeedbackDedupeHits()
+{
+    unsigned long long numDedupeHits = 0;
+    
     for(auto processor : feedbackProcessors_)
-        processor->ForceClear();
+        numDedupeHits += processor->GetNumDedupeHits();
+    
+    return numDedupeHits;
 }
 
 void Widget::ClearCache()
@@ -1986,12 +4515,7 @@ void Widget::ClearCache()
 
 void Widget::LogInput(double value)
 {
-    if(TheManager->GetSurfaceInDisplay())
-    {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "IN <- %s %s %f\n", GetSurface()->GetName().c_str(), GetName().c_str(), value);
-        DAW::ShowConsoleMsg(buffer);
-    }
+    TraceMessage(TraceWidgetIn, GetSurface()->GetName(), GetName(), value, TheManager->GetSurfaceInDisplay());
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2007,21 +4531,35 @@ CSIMessageGenerator::CSIMessageGenerator(ControlSurface* surface, Widget* widget
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void Midi_FeedbackProcessor::SendMidiMessage(MIDI_event_ex_t* midiMessage)
 {
-    surface_->SendMidiMessage(midiMessage);
+    surface_->SendMidiMessage(midiMessage, this);
+}
+
+void Midi_FeedbackProcessor::SendMidiMessage(int first, int second, int third)
+{
+    if(first != lastMessageSent_->midi_message[0] || second != lastMessageSent_->midi_message[1] || third != lastMessageSent_->midi_message[2])
+    {
+        lastMessageSent_->midi_message[0] = first;
+        lastMessageSent_->midi_message[1] = second;
+        lastMessageSent_->midi_message[2] = third;
+        surface_->SendChangedMidiMessage(first, second, third, this);
+    }
+    else
+        numDedupeHits_++;
 }
 
-void Midi_FeedbackProcessor::SendMidiMessage(int first, int second, int third)
+void Midi_FeedbackProcessor::QueueRGBValue(int r, int g, int b)
 {
-    if(first != lastMessageSent_->midi_message[0] || second != lastMessageSent_->midi_message[1] || third != lastMessageSent_->midi_message[2])
-        ForceMidiMessage(first, second, third);
+    surface_->QueueRGBValue(this, r, g, b);
 }
 
 void Midi_FeedbackProcessor::ForceMidiMessage(int first, int second, int third)
 {
+    lastStep_ = -1; // forced values don't go through Quantize, so the next one is always sent
+    
     lastMessageSent_->midi_message[0] = first;
     lastMessageSent_->midi_message[1] = second;
     lastMessageSent_->midi_message[2] = third;
-    surface_->SendMidiMessage(first, second, third);
+    surface_->SendMidiMessage(first, second, third, this);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2029,22 +4567,37 @@ void Midi_FeedbackProcessor::ForceMidiMessage(int first, int second, int third)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void OSC_FeedbackProcessor::SetRGBValue(int r, int g, int b)
 {
+    if(colorFormat_ != OSCColorSeparate)
+    {
+        if(lastRValue != r || lastGValue != g || lastBValue != b)
+        {
+            lastRValue = r;
+            lastGValue = g;
+            lastBValue = b;
+            surface_->SendOSCColorMessage(this, colorAddress_, colorFormat_, r, g, b);
+        }
+        else
+            numDedupeHits_++;
+        
+        return;
+    }
+    
     if(lastRValue != r)
     {
         lastRValue = r;
-        surface_->SendOSCMessage(this, oscAddress_ + "/rColor", r);
+        surface_->SendOSCMessage(this, rColorAddress_, r);
     }
     
     if(lastGValue != g)
     {
         lastGValue = g;
-        surface_->SendOSCMessage(this, oscAddress_ + "/gColor", g);
+        surface_->SendOSCMessage(this, gColorAddress_, g);
     }
     
     if(lastBValue != b)
     {
         lastBValue = b;
-        surface_->SendOSCMessage(this, oscAddress_ + "/bColor", b);
+        surface_->SendOSCMessage(this, bColorAddress_, b);
     }
 }
 
@@ -2060,7 +4613,7 @@ void OSC_FeedbackProcessor::ForceValue(int param, double value)
     surface_->SendOSCMessage(this, oscAddress_, value);
 }
 
-void OSC_FeedbackProcessor::ForceValue(string value)
+void OSC_FeedbackProcessor::ForceValue(const string &value)
 {
     lastStringValue_ = value;
     surface_->SendOSCMessage(this, oscAddress_, value);
@@ -2077,12 +4630,35 @@ ControlSurface::ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, con
     LoadDefaultZoneOrder();
 }
 
+bool ControlSurface::GetAreFilesReady()
+{
+    return tokenizedFiles_.GetIsReady(DAW::GetResourcePath() + GetSourceFileName()) && tokenizedFiles_.GetIsZoneFolderReady(DAW::GetResourcePath() + string("/CSI/Zones/") + zoneFolder_ + "/");
+}
+
+string ControlSurface::GetCurrentFilesStamp()
+{
+    string filesStamp = tokenizedFiles_.GetStamp(DAW::GetResourcePath() + GetSourceFileName());
+    
+    vector<string> zoneFiles;
+    tokenizedFiles_.GetZoneFiles(DAW::GetResourcePath() + string("/CSI/Zones/") + zoneFolder_ + "/", zoneFiles);
+    sort(zoneFiles.begin(), zoneFiles.end());
+    
+    for(auto &zoneFile : zoneFiles)
+        filesStamp += "\x1e" + zoneFile + tokenizedFiles_.GetStamp(zoneFile);
+    
+    return filesStamp;
+}
+
 void ControlSurface::InitZones(string zoneFolder)
 {
     try
     {
+        string zoneFolderPath = DAW::GetResourcePath() + string("/CSI/Zones/") + zoneFolder + "/";
+        
         vector<string> zoneFilesToProcess;
-        listZoneFiles(DAW::GetResourcePath() + string("/CSI/Zones/") + zoneFolder + "/", zoneFilesToProcess); // recursively find all the .zon files, starting at zoneFolder
+        
+        if( ! tokenizedFiles_.GetZoneFiles(zoneFolderPath, zoneFilesToProcess)) // the workers' listing of every .zon file under zoneFolder
+            listZoneFiles(zoneFolderPath, zoneFilesToProcess);
         
         for(auto zoneFilename : zoneFilesToProcess)
             PreProcessZoneFile(zoneFilename, this);
@@ -2095,10 +4671,36 @@ void ControlSurface::InitZones(string zoneFolder)
     }
 }
 
-void ControlSurface::SurfaceOutMonitor(Widget* widget, string address, string value)
+// On a feedback worker, nothing here reads REAPER or touches another surface
+void ControlSurface::ComputeFeedback()
+{
+    for(auto &snapshot : feedbackSnapshots_)
+    {
+        if(snapshot.context != nullptr)
+            snapshot.context->ApplyFeedback(snapshot, feedbackText_.data() + snapshot.textOffset, snapshot.textSize);
+        else if(snapshot.kind == FeedbackForceClear)
+            snapshot.widget->ForceClear();
+        else
+            snapshot.widget->Clear();
+    }
+    
+    feedbackSnapshots_.clear();
+    feedbackText_.clear();
+}
+
+unsigned long long ControlSurface::GetNumFeedbackDedupeHits()
+{
+    unsigned long long numDedupeHits = 0;
+    
+    for(auto widget : widgets_)
+        numDedupeHits += widget->GetNumFeedbackDedupeHits();
+    
+    return numDedupeHits;
+}
+
+void ControlSurface::SurfaceOutMonitor(Widget* widget, const string &address, const string &value)
 {
-    if(TheManager->GetSurfaceOutDisplay())
-        DAW::ShowConsoleMsg(("OUT->" + name_ + " " + address + " " + value + "\n").c_str());
+    TraceMessage(TraceOSCOut, name_, address, value, TheManager->GetSurfaceOutDisplay());
 }
 
 Navigator* ControlSurface::GetNavigatorForChannel(int channelNum)
@@ -2337,6 +4939,8 @@ void ControlSurface::UnmapSelectedTrackFXFromWidgets()
 
 void ControlSurface::MapSelectedTrackFXToWidgets()
 {
+    TraceSpan span("MapSelectedTrackFXToWidgets", name_);
+    
     UnmapSelectedTrackFXFromWidgets();
     
     if(MediaTrack* selectedTrack = GetPage()->GetSelectedTrack())
@@ -2382,18 +4986,14 @@ void ControlSurface::UnmapFocusedFXFromWidgets()
     activeFocusedFXZones_.clear();
 }
 
-void ControlSurface::MapFocusedFXToWidgets()
+void ControlSurface::MapFocusedFXToWidgets(int trackNumber, int fxSlot)
 {
     UnmapFocusedFXFromWidgets();
     
-    int trackNumber = 0;
-    int itemNumber = 0;
-    int fxSlot = 0;
     MediaTrack* focusedTrack = nullptr;
     
-    if(DAW::GetFocusedFX2(&trackNumber, &itemNumber, &fxSlot) == 1)
-        if(trackNumber > 0)
-            focusedTrack = DAW::GetTrack(trackNumber);
+    if(trackNumber > 0)
+        focusedTrack = DAW::GetTrack(trackNumber);
     
     if(focusedTrack)
     {
@@ -2411,6 +5011,22 @@ void ControlSurface::MapFocusedFXToWidgets()
     }
 }
 
+void ControlSurface::LoadFocusedFXZone(int trackNumber, int fxSlot)
+{
+    MediaTrack* focusedTrack = nullptr;
+    
+    if(trackNumber > 0)
+        focusedTrack = DAW::GetTrack(trackNumber);
+    
+    if(focusedTrack)
+    {
+        char FXName[BUFSZ];
+        DAW::TrackFX_GetFXName(focusedTrack, fxSlot, FXName, sizeof(FXName));
+        
+        LoadZone(FXName);
+    }
+}
+
 void ControlSurface::TrackFXListChanged()
 {
     OnTrackSelection();
@@ -2436,8 +5052,48 @@ void ControlSurface::LoadZone(string zoneName)
     }
 }
 
+void ControlSurface::ReloadZoneFile(string filePath)
+{
+    string zoneFolderPath = DAW::GetResourcePath() + string("/CSI/Zones/") + zoneFolder_ + "/";
+    
+    if(filePath.compare(0, zoneFolderPath.length(), zoneFolderPath) != 0)
+        return;
+    
+    filesStamp_ = GetCurrentFilesStamp(); // this surface is current again, a later reset can keep it
+    
+    PreProcessZoneFile(filePath, this); // new file or renamed Zone
+    
+    bool isLoaded = false;
+    vector<Widget*> affectedWidgets;
+    
+    for(auto zone : zones_)
+    {
+        if(zone->GetSourceFilePath() == filePath)
+        {
+            isLoaded = true;
+            affectedWidgets.insert(affectedWidgets.end(), zone->GetWidgets().begin(), zone->GetWidgets().end());
+        }
+    }
+    
+    if( ! isLoaded) // it will be read when first needed
+        return;
+    
+    ProcessZoneFile(filePath, this);
+    
+    for(auto zone : zones_)
+        if(zone->GetSourceFilePath() == filePath)
+            affectedWidgets.insert(affectedWidgets.end(), zone->GetWidgets().begin(), zone->GetWidgets().end());
+    
+    // Only these widgets resend, and the device state passes on only what actually changed
+    for(auto widget : affectedWidgets)
+        widget->ClearCache();
+}
+
 Zone* ControlSurface::GetZone(string zoneName)
 {
+    if( ! isOnline_) // zones loaded before the widgets exist would stay empty
+        return nullptr;
+    
     if(zonesByName_.count(zoneName) > 0)
         return zonesByName_[zoneName];
 
@@ -2492,6 +5148,10 @@ void ControlSurface::GoZone(string zoneName, double value)
 
 void ControlSurface::GoZone(vector<Zone*> *activeZones, string zoneName, double value)
 {
+    TraceSpan span("GoZone", name_, zoneName);
+    
+    stats_.numZoneActivations++;
+    
     if(zoneName == "Home")
     {
         activeZones_.clear();
@@ -2538,108 +5198,412 @@ void ControlSurface::GoZone(vector<Zone*> *activeZones, string zoneName, double
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Midi_ControlSurface
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-void Midi_ControlSurface::InitWidgets(string templateFilename, string zoneFolder)
+void Midi_ControlSurface::InitWidgets()
 {
-    ProcessWidgetFile(string(DAW::GetResourcePath()) + "/CSI/Surfaces/Midi/" + templateFilename, this);
+    ProcessWidgetFile(string(DAW::GetResourcePath()) + "/CSI/Surfaces/Midi/" + templateFilename_, this);
     InitHardwiredWidgets();
     Initialize();
-    InitZones(zoneFolder);
+    InitZones(zoneFolder_);
     MakeHomeDefault();
     ForceClearAllWidgets();
     GetPage()->ForceRefreshTimeDisplay();
 }
 
-void Midi_ControlSurface::ProcessMidiMessage(const MIDI_event_ex_t* evt)
+Midi_ControlSurface::~Midi_ControlSurface()
 {
-    bool isMapped = false;
+    SendColorBatch(); // the processors live in the arena, which goes after this
     
-    // At this point we don't know how much of the message comprises the key, so try all three
-    if(Midi_CSIMessageGeneratorsByMessage_.count(evt->midi_message[0] * 0x10000 + evt->midi_message[1] * 0x100 + evt->midi_message[2]) > 0)
+    if(midiInputQueue_)
+        ReleaseMidiInputQueue(midiInputQueue_);
+}
+
+void Midi_ControlSurface::QueueRGBValue(Midi_FeedbackProcessor* processor, int r, int g, int b)
+{
+    for(auto &color : colorBatch_)
     {
-        isMapped = true;
-        for( auto generator : Midi_CSIMessageGeneratorsByMessage_[evt->midi_message[0] * 0x10000 + evt->midi_message[1] * 0x100 + evt->midi_message[2]])
-            generator->ProcessMidiMessage(evt);
+        if(color.processor == processor) // only the last colour in a frame matters
+        {
+            color.r = r;
+            color.g = g;
+            color.b = b;
+            return;
+        }
     }
-    else if(Midi_CSIMessageGeneratorsByMessage_.count(evt->midi_message[0] * 0x10000 + evt->midi_message[1] * 0x100) > 0)
+    
+    QueuedColor color;
+    color.processor = processor;
+    color.r = r;
+    color.g = g;
+    color.b = b;
+    
+    colorBatch_.push_back(color);
+}
+
+void Midi_ControlSurface::SendColorBatch()
+{
+    if(colorBatch_.size() == 0)
+        return;
+    
+    struct
     {
-        isMapped = true;
-        for( auto generator : Midi_CSIMessageGeneratorsByMessage_[evt->midi_message[0] * 0x10000 + evt->midi_message[1] * 0x100])
-            generator->ProcessMidiMessage(evt);
+        MIDI_event_ex_t evt;
+        char data[MidiOutputMaxMessageSize];
+    } midiSysExData;
+    
+    midiSysExData.evt.frame_offset = 0;
+    midiSysExData.evt.size = 0;
+    
+    unsigned char header[16];
+    int headerSize = 0;
+    int segmentStart = 0;
+    
+    for(int i = 0; i < (int)colorBatch_.size(); i++)
+    {
+        QueuedColor &color = colorBatch_[i];
+        
+        unsigned char colorHeader[16];
+        int colorHeaderSize = color.processor->GetColorSysExHeader(colorHeader);
+        
+        if(colorHeaderSize == 0)
+        {
+            int numUnsent = (int)unsentSources_.size();
+            
+            color.processor->SendRGBValue(color.r, color.g, color.b);
+            
+            color.isSent = (int)unsentSources_.size() == numUnsent;
+            continue;
+        }
+        
+        unsigned char entry[16];
+        int entrySize = color.processor->GetColorSysExEntry(color.r, color.g, color.b, entry);
+        
+        bool isSameDevice = colorHeaderSize == headerSize && memcmp(colorHeader, header, headerSize) == 0;
+        
+        if( ! isSameDevice || midiSysExData.evt.size + entrySize + 1 > MidiOutputMaxMessageSize)
+        {
+            if(midiSysExData.evt.size > 0)
+                SendColorSysEx(&midiSysExData.evt, headerSize, segmentStart, i);
+            
+            memcpy(header, colorHeader, colorHeaderSize);
+            headerSize = colorHeaderSize;
+            
+            memcpy(midiSysExData.evt.midi_message, header, headerSize);
+            midiSysExData.evt.size = headerSize;
+            segmentStart = i;
+        }
+        
+        memcpy(midiSysExData.evt.midi_message + midiSysExData.evt.size, entry, entrySize);
+        midiSysExData.evt.size += entrySize;
+        color.isMerged = true;
+    }
+    
+    if(midiSysExData.evt.size > 0)
+        SendColorSysEx(&midiSysExData.evt, headerSize, segmentStart, (int)colorBatch_.size());
+    
+    // Colours that didn't make it into the output queue stay for the next update
+    int numKept = 0;
+    
+    for(auto &color : colorBatch_)
+    {
+        if( ! color.isSent)
+        {
+            color.isSent = true;
+            color.isMerged = false;
+            colorBatch_[numKept++] = color;
+        }
     }
-    else if(Midi_CSIMessageGeneratorsByMessage_.count(evt->midi_message[0] * 0x10000) > 0)
+    
+    colorBatch_.resize(numKept);
+}
+
+void Midi_ControlSurface::SendColorSysEx(MIDI_event_ex_t* evt, int headerSize, int start, int end)
+{
+    evt->midi_message[evt->size++] = 0xF7;
+    
+    // A batch for the same device and the same pads replaces one still waiting on a paced port, so it needs the same
+    // source every time, one batch can't stand in for another with different pads
+    unsigned long long hash = 14695981039346656037ULL;
+    
+    for(int i = 0; i < headerSize; i++)
+        hash = (hash ^ evt->midi_message[i]) * 1099511628211ULL;
+    
+    for(int i = start; i < end; i++)
+        if(colorBatch_[i].isMerged)
+            hash = (hash ^ (unsigned long long)(uintptr_t)colorBatch_[i].processor) * 1099511628211ULL;
+    
+    const void* key = &*colorBatchKeys_.insert(hash).first;
+    
+    if( ! SendReplaceableMidiMessage(evt, key, MidiOutputPriorityColour))
+        for(int i = start; i < end; i++)
+            if(colorBatch_[i].isMerged)
+                colorBatch_[i].isSent = false;
+}
+
+vector<Midi_CSIMessageGenerator*>* Midi_ControlSurface::GetMessageGenerators(const MIDI_event_ex_t* evt)
+{
+    // At this point we don't know how much of the message comprises the key, so try all three
+    auto it = Midi_CSIMessageGeneratorsByMessage_.find(evt->midi_message[0] * 0x10000 + evt->midi_message[1] * 0x100 + evt->midi_message[2]);
+    
+    if(it == Midi_CSIMessageGeneratorsByMessage_.end())
+        it = Midi_CSIMessageGeneratorsByMessage_.find(evt->midi_message[0] * 0x10000 + evt->midi_message[1] * 0x100);
+    
+    if(it == Midi_CSIMessageGeneratorsByMessage_.end())
+        it = Midi_CSIMessageGeneratorsByMessage_.find(evt->midi_message[0] * 0x10000);
+    
+    return it != Midi_CSIMessageGeneratorsByMessage_.end() ? &it->second : nullptr;
+}
+
+void Midi_ControlSurface::ProcessMidiMessage(const MIDI_event_ex_t* evt)
+{
+    bool isMapped = false;
+    
+    if(vector<Midi_CSIMessageGenerator*>* generators = GetMessageGenerators(evt))
     {
         isMapped = true;
-        for( auto generator : Midi_CSIMessageGeneratorsByMessage_[evt->midi_message[0] * 0x10000])
+        for( auto generator : *generators)
             generator->ProcessMidiMessage(evt);
     }
     
-    if(TheManager->GetSurfaceRawInDisplay() || (! isMapped && TheManager->GetSurfaceInDisplay()))
+    stats_.numMessagesReceived++;
+    
+    if(isMapped)
+        stats_.numMessagesDispatched++;
+    else
+        stats_.numMessagesUnmapped++;
+    
+    TraceMidi(TraceMidiIn, name_, evt->midi_message, 3, TheManager->GetSurfaceRawInDisplay() || (! isMapped && TheManager->GetSurfaceInDisplay()));
+}
+
+void Midi_ControlSurface::AddUnsentSource(Midi_FeedbackProcessor* source)
+{
+    if(source != nullptr && (unsentSources_.size() == 0 || unsentSources_.back() != source))
+        unsentSources_.push_back(source);
+}
+
+void Midi_ControlSurface::ClearUnsentSources()
+{
+    // Their caches already hold what was dropped, clearing them makes the next update send it again
+    for(auto source : unsentSources_)
+        source->ClearCache();
+    
+    unsentSources_.clear();
+}
+
+bool Midi_ControlSurface::SendMidiMessage(MIDI_event_ex_t* midiMessage, Midi_FeedbackProcessor* source)
+{
+    return SendMidiMessage(midiMessage, source, source != nullptr ? source->GetOutputPriority() : MidiOutputPriorityState);
+}
+
+void Midi_ControlSurface::HoldMidiMessage(HeldMidiMessageType type, const unsigned char* bytes, int size, Midi_FeedbackProcessor* source, int priority)
+{
+    HeldMidiMessage heldMessage;
+    heldMessage.type = type;
+    heldMessage.source = source;
+    heldMessage.priority = priority;
+    heldMessage.offset = (int)heldBytes_.size();
+    heldMessage.size = size;
+    
+    heldMessages_.push_back(heldMessage);
+    heldBytes_.insert(heldBytes_.end(), bytes, bytes + size);
+}
+
+// Back on the main thread, the device state, stats and trace are all shared with the rest of Run
+void Midi_ControlSurface::TransmitFeedback()
+{
+    for(auto &heldMessage : heldMessages_)
     {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "IN <- %s %02x  %02x  %02x \n", name_.c_str(), evt->midi_message[0], evt->midi_message[1], evt->midi_message[2]);
-        DAW::ShowConsoleMsg(buffer);
+        unsigned char* bytes = heldBytes_.data() + heldMessage.offset;
+        
+        if(heldMessage.type == HeldMidiChanged)
+            SendChangedMidiMessage(bytes[0], bytes[1], bytes[2], heldMessage.source);
+        else if(heldMessage.type == HeldMidiShort)
+            SendMidiMessage(bytes[0], bytes[1], bytes[2], heldMessage.source);
+        else
+        {
+            if(heldEvent_.size() < sizeof(MIDI_event_ex_t) + heldMessage.size)
+                heldEvent_.resize(sizeof(MIDI_event_ex_t) + heldMessage.size);
+            
+            MIDI_event_ex_t* evt = (MIDI_event_ex_t*)heldEvent_.data();
+            evt->frame_offset = 0;
+            evt->size = heldMessage.size;
+            memcpy(evt->midi_message, bytes, heldMessage.size);
+            
+            SendMidiMessage(evt, heldMessage.source, heldMessage.priority);
+        }
     }
+    
+    heldMessages_.clear();
+    heldBytes_.clear();
+    
+    SendColorBatch();
 }
 
-void Midi_ControlSurface::SendMidiMessage(MIDI_event_ex_t* midiMessage)
+bool Midi_ControlSurface::SendMidiMessage(MIDI_event_ex_t* midiMessage, Midi_FeedbackProcessor* source, int priority)
 {
-    if(midiOutput_)
-        midiOutput_->SendMsg(midiMessage, -1);
+    if(isHoldingSends_)
+    {
+        HoldMidiMessage(HeldMidiEvent, midiMessage->midi_message, midiMessage->size, source, priority);
+        return true;
+    }
     
-    string output = "OUT->" + name_ + " ";
+    if(SendReplaceableMidiMessage(midiMessage, source, priority))
+        return true;
     
-    for(int i = 0; i < midiMessage->size; i++)
+    AddUnsentSource(source);
+    return false;
+}
+
+bool Midi_ControlSurface::SendReplaceableMidiMessage(MIDI_event_ex_t* midiMessage, const void* key, int priority)
+{
+    if(midiOutputQueue_)
     {
-        char buffer[32];
-        
-        snprintf(buffer, sizeof(buffer), "%02x ", midiMessage->midi_message[i]);
-        
-        output += buffer;
+        if( ! PushMidiOutputMessage(midiOutputQueue_, midiMessage->midi_message, midiMessage->size, key, priority))
+        {
+            stats_.numMessagesDropped++;
+            return false;
+        }
     }
+    else if(midiOutput_)
+        midiOutput_->SendMsg(midiMessage, -1);
     
-    output += "\n";
+    CountMessageSent(midiMessage->size);
+    
+    TraceMidi(TraceMidiOut, name_, midiMessage->midi_message, midiMessage->size, TheManager->GetSurfaceOutDisplay());
+    
+    return true;
+}
 
-    if(TheManager->GetSurfaceOutDisplay())
-        DAW::ShowConsoleMsg(output.c_str());
+void Midi_ControlSurface::SendChangedMidiMessage(int first, int second, int third, Midi_FeedbackProcessor* source)
+{
+    if(isHoldingSends_) // the device state is the port's, other surfaces' workers could be looking at it too
+    {
+        unsigned char bytes[3] = { (unsigned char)first, (unsigned char)second, (unsigned char)third };
+        HoldMidiMessage(HeldMidiChanged, bytes, 3, source, MidiOutputPriorityState);
+    }
+    else if(deviceState_ == nullptr || ! deviceState_->GetIsShowing(first, second, third))
+        SendMidiMessage(first, second, third, source);
+    else
+        stats_.numDeviceStateHits++;
 }
 
-void Midi_ControlSurface::SendMidiMessage(int first, int second, int third)
+bool Midi_ControlSurface::SendMidiMessage(int first, int second, int third, Midi_FeedbackProcessor* source)
 {
-    if(midiOutput_)
-        midiOutput_->Send(first, second, third, -1);
+    unsigned char bytes[3] = { (unsigned char)first, (unsigned char)second, (unsigned char)third };
     
-    if(TheManager->GetSurfaceOutDisplay())
+    if(isHoldingSends_)
     {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "%s  %02x  %02x  %02x \n", ("OUT->" + name_).c_str(), first, second, third);
-        DAW::ShowConsoleMsg(buffer);
+        HoldMidiMessage(HeldMidiShort, bytes, 3, source, MidiOutputPriorityState);
+        return true;
+    }
+    
+    if(midiOutputQueue_)
+    {
+        if( ! PushMidiOutputMessage(midiOutputQueue_, bytes, 3, source, source != nullptr ? source->GetOutputPriority() : MidiOutputPriorityState))
+        {
+            stats_.numMessagesDropped++;
+            AddUnsentSource(source);
+            return false;
+        }
     }
+    else if(midiOutput_)
+        midiOutput_->Send(first, second, third, -1);
+    
+    if(deviceState_) // only once the message is on its way, so a dropped one isn't taken as showing
+        deviceState_->Update(first, second, third);
+    
+    CountMessageSent(3);
+    
+    if(TheManager->GetSurfaceOutDisplay() || GetIsCapturingTrace())
+        TraceMidi(TraceMidiOut, name_, bytes, 3, TheManager->GetSurfaceOutDisplay());
+    
+    return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // OSC_ControlSurface
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-void OSC_ControlSurface::InitWidgets(string templateFilename, string zoneFolder)
+void OSC_ControlSurface::InitWidgets()
 {
-    ProcessWidgetFile(string(DAW::GetResourcePath()) + "/CSI/Surfaces/OSC/" + templateFilename, this);
+    ProcessWidgetFile(string(DAW::GetResourcePath()) + "/CSI/Surfaces/OSC/" + templateFilename_, this);
     InitHardwiredWidgets();
-    InitZones(zoneFolder);
+    InitZones(zoneFolder_);
     MakeHomeDefault();
     ForceClearAllWidgets();
     GetPage()->ForceRefreshTimeDisplay();
 }
 
+void OSC_ControlSurface::HandleExternalInput()
+{
+    int numProcessed = 0;
+    
+    if(inputQueue_ != nullptr) // the surface's receive thread has already read and parsed the socket
+    {
+        OSCInputMessage inputMessage;
+        
+        while(numProcessed < OSCMaxMessagesPerRun && inputQueue_->Pop(inputMessage))
+        {
+            inputTimestamp_ = inputMessage.timestamp;
+            ProcessOSCMessage(inputMessage.address, inputMessage.value);
+            numProcessed++;
+        }
+        
+        if(inputQueue_->GetNumDropped() != numDroppedMessagesReported_ && TheManager->GetSurfaceInDisplay())
+        {
+            char buffer[250];
+            snprintf(buffer, sizeof(buffer), "IN <- %s dropped %d OSC messages, input queue full\n", name_.c_str(), inputQueue_->GetNumDropped() - numDroppedMessagesReported_);
+            DAW::ShowConsoleMsg(buffer);
+        }
+        
+        numDroppedMessagesReported_ = inputQueue_->GetNumDropped();
+    }
+    else if(inSocket_ != nullptr && inSocket_->isOk())
+    {
+        while (numProcessed < OSCMaxMessagesPerRun && inSocket_->receiveNextPacket(0))  // timeout, in ms
+        {
+            inputTimestamp_ = DAW::GetPreciseNumberOfMilliseconds();
+            
+            packetReader_.init(inSocket_->packetData(), inSocket_->packetSize());
+            oscpkt::Message *message;
+            
+            while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
+            {
+                float value = 0;
+                
+                if(message->arg().isFloat())
+                {
+                    message->arg().popFloat(value);
+                    ProcessOSCMessage(message->addressPattern(), value);
+                    numProcessed++;
+                }
+            }
+        }
+    }
+    
+    if(numProcessed >= OSCMaxMessagesPerRun)
+        numOverflowedRuns_++;
+}
+
 void OSC_ControlSurface::ProcessOSCMessage(string message, double value)
 {
-    if(CSIMessageGeneratorsByMessage_.count(message) > 0)
-        CSIMessageGeneratorsByMessage_[message]->ProcessMessage(value);
+    stats_.numMessagesReceived++;
     
-    if(TheManager->GetSurfaceInDisplay())
+    if(CSIMessageGeneratorsByMessage_.count(message) > 0)
     {
-        char buffer[250];
-        snprintf(buffer, sizeof(buffer), "IN <- %s %s  %f  \n", name_.c_str(), message.c_str(), value);
-        DAW::ShowConsoleMsg(buffer);
+        CSIMessageGeneratorsByMessage_[message]->ProcessMessage(value);
+        stats_.numMessagesDispatched++;
     }
+    else
+        stats_.numMessagesUnmapped++;
+    
+    TraceMessage(TraceOSCIn, name_, message, value, TheManager->GetSurfaceInDisplay());
+}
+
+static void PushColor(oscpkt::Message &message, OSCColorFormat colorFormat, int r, int g, int b)
+{
+    if(colorFormat == OSCColorRGBA)
+        message.pushRgba(((uint32_t)(r & 0xff) << 24) | ((g & 0xff) << 16) | ((b & 0xff) << 8) | 0xff);
+    else
+        message.pushInt32(r).pushInt32(g).pushInt32(b);
 }
 
 void OSC_ControlSurface::LoadingZone(string zoneName)
@@ -2650,47 +5614,60 @@ void OSC_ControlSurface::LoadingZone(string zoneName)
 
     if(outSocket_ != nullptr && outSocket_->isOk())
     {
-        oscpkt::Message message;
+        oscpkt::Message &message = outMessage_;
         message.init(oscAddress);
         packetWriter_.init().addMessage(message);
         outSocket_->sendPacket(packetWriter_.packetData(), packetWriter_.packetSize());
+        CountMessageSent(packetWriter_.packetSize());
     }
     
-    if(TheManager->GetSurfaceOutDisplay())
-        DAW::ShowConsoleMsg((zoneName + "->" + "LoadingZone---->" + name_ + "\n").c_str());
+    TraceMessage(TraceZoneLoad, name_, zoneName, 0.0, TheManager->GetSurfaceOutDisplay());
 }
 
-void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, double value)
+void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, const string &oscAddress, double value)
 {
     if(outSocket_ != nullptr && outSocket_->isOk())
     {
-        oscpkt::Message message;
+        oscpkt::Message &message = outMessage_;
         message.init(oscAddress).pushFloat(value);
         packetWriter_.init().addMessage(message);
         outSocket_->sendPacket(packetWriter_.packetData(), packetWriter_.packetSize());
+        CountMessageSent(packetWriter_.packetSize());
     }
     
-    if(TheManager->GetSurfaceOutDisplay())
-    {
-        if(TheManager->GetSurfaceOutDisplay())
-            DAW::ShowConsoleMsg(("OUT->" + name_ + " " + oscAddress + " " + to_string(value) + "\n").c_str());
-    }
+    TraceMessage(TraceOSCOut, name_, oscAddress, value, TheManager->GetSurfaceOutDisplay());
 }
 
-void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, string value)
+void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, const string &oscAddress, const string &value)
 {
     if(outSocket_ != nullptr && outSocket_->isOk())
     {
-        oscpkt::Message message;
+        oscpkt::Message &message = outMessage_;
         message.init(oscAddress).pushStr(value);
         packetWriter_.init().addMessage(message);
         outSocket_->sendPacket(packetWriter_.packetData(), packetWriter_.packetSize());
+        CountMessageSent(packetWriter_.packetSize());
     }
     
     SurfaceOutMonitor(feedbackProcessor->GetWidget(), oscAddress, value);
     
 }
 
+void OSC_ControlSurface::SendOSCColorMessage(OSC_FeedbackProcessor* feedbackProcessor, const string &oscAddress, OSCColorFormat colorFormat, int r, int g, int b)
+{
+    if(outSocket_ != nullptr && outSocket_->isOk())
+    {
+        oscpkt::Message &message = outMessage_;
+        message.init(oscAddress);
+        PushColor(message, colorFormat, r, g, b);
+        packetWriter_.init().addMessage(message);
+        outSocket_->sendPacket(packetWriter_.packetData(), packetWriter_.packetSize());
+        CountMessageSent(packetWriter_.packetSize());
+    }
+    
+    TraceMessage(TraceOSCOut, name_, oscAddress, (r << 16) | (g << 8) | b, TheManager->GetSurfaceOutDisplay());
+}
+
 void Midi_ControlSurface::InitializeMCU()
 {
     vector<vector<int>> sysExLines;
@@ -18,11 +18,20 @@
 #include "time.h"
 #include <sstream>
 #include <vector>
+#include <list>
 #include <map>
+#include <set>
 #include <iomanip>
 #include <fstream>
 #include <regex>
 #include <cmath>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <sys/stat.h>
 
 #ifdef _WIN32
 #include "oscpkt.hh"
@@ -43,6 +52,12 @@
 #include "udp.hh"
 #endif
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
 extern string GetLineEnding();
 
 extern REAPER_PLUGIN_HINSTANCE g_hInst;
@@ -64,6 +79,7 @@ const string CRLFChars = "[\r\n]";
 const string TabChars = "[\t]";
 
 const int TempDisplayTime = 1250;
+const int InactivePageRefreshInterval = 15; // Runs between background refreshes, one inactive page per refresh
 
 enum NavigationStyle
 {
@@ -75,6 +91,14 @@ enum NavigationStyle
     SelectedTrackReceiveSlot,
 };
 
+enum ModifierFlag
+{
+    ShiftFlag = 1,
+    OptionFlag = 2,
+    ControlFlag = 4,
+    AltFlag = 8,
+};
+
 class Manager;
 extern Manager* TheManager;
 
@@ -90,6 +114,321 @@ static vector<string> GetTokens(string line)
     return tokens;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, int Capacity> class LockFreeQueue // single producer, single consumer
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    T items_[Capacity];
+    atomic<int> writeIndex_ { 0 };
+    atomic<int> readIndex_ { 0 };
+    atomic<int> numDropped_ { 0 };
+    
+public:
+    bool Push(const T &item, int numReserved = 0) // numReserved slots are left free for pushes that must not fail
+    {
+        int writeIndex = writeIndex_.load(memory_order_relaxed);
+        int nextIndex = (writeIndex + 1) % Capacity;
+        int size = (writeIndex - readIndex_.load(memory_order_acquire) + Capacity) % Capacity;
+        
+        if(size + numReserved >= Capacity - 1)
+        {
+            numDropped_++;
+            return false;
+        }
+        
+        items_[writeIndex] = item;
+        writeIndex_.store(nextIndex, memory_order_release);
+        
+        return true;
+    }
+    
+    bool Pop(T &item)
+    {
+        int readIndex = readIndex_.load(memory_order_relaxed);
+        
+        if(readIndex == writeIndex_.load(memory_order_acquire))
+            return false;
+        
+        item = items_[readIndex];
+        readIndex_.store((readIndex + 1) % Capacity, memory_order_release);
+        
+        return true;
+    }
+    
+    void AddDropped() { numDropped_++; }
+    int GetNumDropped() { return numDropped_; }
+    int GetSize() { return (writeIndex_.load(memory_order_relaxed) - readIndex_.load(memory_order_relaxed) + Capacity) % Capacity; } // approximate from the other thread
+};
+
+const int MidiInputMaxMessageSize = 256; // longer sysex from the input thread is dropped and counted
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TimestampedMidiEvent
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    double timestamp = 0.0; // milliseconds, DAW::GetPreciseNumberOfMilliseconds() timebase
+    MIDI_event_ex_t event;
+    unsigned char sysExData[MidiInputMaxMessageSize]; // event.midi_message runs on into this for sysex
+};
+
+const int MidiInputQueueSize = 4096;
+
+typedef LockFreeQueue<TimestampedMidiEvent, MidiInputQueueSize> MidiInputQueue;
+
+const int MidiOutputMaxMessageSize = 512; // the longest display sysex is well under this
+
+enum MidiOutputPriority // when a port is over its byte budget, lower values go out first
+{
+    MidiOutputPriorityState,
+    MidiOutputPriorityText,
+    MidiOutputPriorityMeter,
+    MidiOutputPriorityColour,
+    NumMidiOutputPriorities
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct MidiOutputMessage
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    int priority = MidiOutputPriorityState;
+    const void* source = nullptr; // the feedback processor, a newer message from it to the same address replaces one still waiting
+    int size = 0;
+    unsigned char bytes[MidiOutputMaxMessageSize];
+};
+
+const int MidiOutputQueueSize = 1024;
+
+typedef LockFreeQueue<MidiOutputMessage, MidiOutputQueueSize> MidiOutputQueue;
+
+const int MidiOutputMaxWaitingPerPriority = 256; // held back by pacing, past this the oldest of that priority is dropped
+
+const int OSCMaxAddressLength = 128;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct OSCInputMessage
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    double timestamp = 0.0;
+    float value = 0.0;
+    char address[OSCMaxAddressLength];
+};
+
+const int OSCInputQueueSize = 4096;
+const int OSCMaxMessagesPerRun = 512; // per surface, anything beyond this waits for the next Run
+
+typedef LockFreeQueue<OSCInputMessage, OSCInputQueueSize> OSCInputQueue;
+
+enum TraceRecordType
+{
+    TraceMidiIn,
+    TraceMidiOut,
+    TraceOSCIn,
+    TraceOSCOut,
+    TraceWidgetIn,
+    TraceZoneLoad,
+    TraceText,
+    TraceSpanBegin,
+    TraceSpanEnd,
+    TraceCaptureBegin,
+    TraceCaptureEnd,
+};
+
+const int TraceNameLength = 32;
+const int TraceTextLength = 96;
+const int TraceMaxMidiBytes = 48; // longer sysex keeps its length but not its tail
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TraceRecord // raw copies only, the trace thread does all the formatting
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    double timestamp = 0.0;
+    TraceRecordType type = TraceText;
+    double value = 0.0;
+    bool hasValue = true;
+    bool isDisplayed = true; // otherwise it's only there for the performance trace
+    int numBytes = 0;
+    unsigned char bytes[TraceMaxMidiBytes];
+    char surface[TraceNameLength];
+    char address[TraceTextLength];
+    char text[TraceTextLength];
+};
+
+const int TraceQueueSize = 4096; // a page change with a capture running can burst well past a frame's worth
+
+typedef LockFreeQueue<TraceRecord, TraceQueueSize> TraceQueue;
+
+// Main thread only, these return straight away unless isDisplayed is set or a performance trace is being captured, false if the record was dropped
+void TraceMidi(TraceRecordType type, const string &surfaceName, const unsigned char* bytes, int numBytes, bool isDisplayed);
+bool TraceMessage(TraceRecordType type, const string &surfaceName, const string &address, double value, bool isDisplayed);
+bool TraceMessage(TraceRecordType type, const string &surfaceName, const string &address, const string &text, bool isDisplayed);
+void FlushTraceToConsole();
+
+bool GetIsCapturingTrace();
+void ToggleTraceCapture();
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TraceSpan // begin/end pair in the performance trace, the end always gets into the queue if the begin did
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    bool const hasBegun_ = false;
+    
+public:
+    TraceSpan(const char* name, const string &surfaceName) : hasBegun_(GetIsCapturingTrace() && TraceMessage(TraceSpanBegin, surfaceName, name, "", false)) {}
+    
+    TraceSpan(const char* name, const string &surfaceName, const string &detail) : hasBegun_(GetIsCapturingTrace() && TraceMessage(TraceSpanBegin, surfaceName, name, detail, false)) {}
+    
+    ~TraceSpan()
+    {
+        if(hasBegun_)
+            TraceMessage(TraceSpanEnd, "", "", 0.0, false);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct PortStats // per MIDI output port or OSC output socket, main thread only
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    unsigned long long numMessagesSent = 0;
+    unsigned long long numBytesSent = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct SurfaceStats // main thread only, read when a snapshot is taken
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    unsigned long long numMessagesReceived = 0;
+    unsigned long long numMessagesDispatched = 0;
+    unsigned long long numMessagesUnmapped = 0;
+    unsigned long long numMessagesSent = 0;
+    unsigned long long numBytesSent = 0;
+    unsigned long long numDeviceStateHits = 0; // sends skipped because the device already shows the value
+    unsigned long long numMessagesDropped = 0; // feedback the output queue had no room for, sent again on the next update
+    unsigned long long numZoneActivations = 0;
+    unsigned long long numZoneFilesParsed = 0;
+    double zoneParseMilliseconds = 0.0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class MidiDeviceState
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // What the hardware on one output port is currently showing, shared by the surfaces of every page on that port
+    // Indexed by status (0x80 - 0xFF) and first data byte, 0 means nothing known
+    unsigned short lastValues_[128][128];
+    
+public:
+    MidiDeviceState() { Clear(); }
+    
+    void Clear() { memset(lastValues_, 0, sizeof(lastValues_)); }
+    
+    bool GetIsShowing(int first, int second, int third)
+    {
+        int value = 0;
+        unsigned short* lastValue = GetLastValue(first, second, third, value);
+        
+        return lastValue != nullptr && *lastValue == value + 1;
+    }
+    
+    void Update(int first, int second, int third)
+    {
+        int value = 0;
+        
+        if(unsigned short* lastValue = GetLastValue(first, second, third, value))
+            *lastValue = value + 1;
+    }
+
+private:
+    unsigned short* GetLastValue(int first, int second, int third, int &value)
+    {
+        int status = first & 0xf0;
+        
+        if(status < 0x80 || status == 0xd0 || status >= 0xf0) // channel pressure drives MCU meters which decay on the device
+            return nullptr;
+        
+        if(status == 0x80) // note off lands on the same address as note on
+        {
+            first = 0x90 | (first & 0x0f);
+            third = 0;
+        }
+        
+        if(status == 0xe0 || status == 0xc0) // the whole message is the value
+        {
+            value = second | (third << 7);
+            return &lastValues_[first - 0x80][0];
+        }
+        
+        value = third;
+        return &lastValues_[first - 0x80][second];
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class SurfaceArena // monotonic, everything goes at once when the surface does
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    static const size_t BlockSize = 64 * 1024;
+    
+    struct Destructor
+    {
+        void* object;
+        void (*destroy)(void*);
+    };
+    
+    vector<char*> blocks_;
+    vector<Destructor> destructors_;
+    size_t blockUsed_ = BlockSize;
+    
+    void* Allocate(size_t size, size_t alignment)
+    {
+        size_t offset = (blockUsed_ + alignment - 1) & ~(alignment - 1);
+        
+        if(blocks_.size() == 0 || offset + size > BlockSize)
+        {
+            // Anything bigger than a block gets a block of its own
+            blocks_.push_back(static_cast<char*>(::operator new(size > BlockSize ? size : BlockSize)));
+            offset = 0;
+        }
+        
+        blockUsed_ = offset + size;
+        
+        return blocks_.back() + offset;
+    }
+    
+public:
+    SurfaceArena() {}
+    SurfaceArena(const SurfaceArena &) = delete;
+    SurfaceArena &operator=(const SurfaceArena &) = delete;
+    
+    ~SurfaceArena() { Release(); }
+    
+    template<typename T, typename... Args> T* New(Args&&... args)
+    {
+        T* object = new (Allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+        
+        if constexpr(! is_trivially_destructible<T>::value)
+            destructors_.push_back({ object, [](void* object) { static_cast<T*>(object)->~T(); } });
+        
+        return object;
+    }
+    
+    void Release()
+    {
+        for(auto it = destructors_.rbegin(); it != destructors_.rend(); ++it)
+            it->destroy(it->object);
+        
+        destructors_.clear();
+        
+        for(auto block : blocks_)
+            ::operator delete(block);
+        
+        blocks_.clear();
+        blockUsed_ = BlockSize;
+    }
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class CSurfIntegrator;
 class Page;
@@ -103,6 +442,10 @@ class Zone;
 class ActionContext;
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Off unless [CSI] FeedbackWorkers is set, ComputeFeedback returns once every surface's update has been applied
+int GetNumFeedbackWorkers();
+void ComputeFeedback(const vector<ControlSurface*> &surfaces);
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Action
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -244,75 +587,128 @@ public:
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class ActionContext
+struct QueuedAcceleratedRelativeAction
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
-private:
-    Action* const action_ = nullptr;
-    Widget* const widget_ = nullptr;
-    Zone* const zone_ = nullptr;
+    QueuedAcceleratedRelativeAction(int idx, double val) : delta(val), index(idx) {}
     
-    Widget* associatedWidget_ = nullptr;
+    double delta = 0.0;
+    int index = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ActionContextTemplate
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Everything parsed out of a zone file action line -- shared by every ActionContext built from the same line, never changes after parsing
+    Action* const action = nullptr;
     
-    string lastStringValue_ = "";
+    int intParam = 0;
+    int paramIndex = 0;
+    int commandId = 0;
+    string stringParam = "";
+    string fxParamDisplayName = "";
+    string associatedWidgetName = "";
     
-    int intParam_ = 0;
+    double rangeMinimum = 0.0;
+    double rangeMaximum = 1.0;
     
-    string stringParam_ = "";
+    vector<double> steppedValues;
+    double deltaValue = 0.0;
+    vector<double> acceleratedDeltaValues;
+    vector<int> acceleratedTickValues;
     
-    int paramIndex_ = 0;
+    bool isFeedbackInverted = false;
+    double holdDelayAmount = 0.0; // milliseconds
     
-    string fxParamDisplayName_ = "";
+    bool shouldUseDisplayStyle = false;
+    int displayStyle = 0;
     
-    int commandId_ = 0;
+    bool supportsRGB = false;
+    vector<rgb_color> RGBValues;
+    bool supportsTrackColor = false;
     
-    double rangeMinimum_ = 0.0;
-    double rangeMaximum_ = 1.0;
+    bool noFeedback = false;
+    bool shouldCoalesce = false;
     
-    vector<double> steppedValues_;
-    int steppedValuesIndex_ = 0;
+    vector<vector<string>> properties;
     
-    double deltaValue_ = 0.0;
-    vector<double> acceleratedDeltaValues_;
-    vector<int> acceleratedTickValues_;
-    int accumulatedIncTicks_ = 0;
-    int accumulatedDecTicks_ = 0;
+    ActionContextTemplate(Action* action, vector<string> params, vector<vector<string>> properties, bool isFeedbackInverted, double holdDelayAmount);
+};
+
+enum FeedbackKind // what a snapshot holds, the conversions and formatting are left for the worker
+{
+    FeedbackValue,
+    FeedbackParamValue,
+    FeedbackText,
+    FeedbackVolume,     // a REAPER volume, shown normalised
+    FeedbackVolumeDB,   // a REAPER volume, shown in dB
+    FeedbackVolumeText, // a REAPER volume, shown as dB text
+    FeedbackPanText,
+    FeedbackPanWidthText,
+    FeedbackClear,
+    FeedbackForceClear
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct FeedbackSnapshot // one widget update as read from REAPER on the main thread, applied later by a feedback worker
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    FeedbackSnapshot(Widget* widget, ActionContext* context, FeedbackKind kind, int param = 0, double value = 0.0) : widget(widget), context(context), kind(kind), param(param), value(value) {}
+    
+    Widget* widget = nullptr;
+    ActionContext* context = nullptr; // nullptr for a widget clearing itself
+    FeedbackKind kind = FeedbackValue;
+    int param = 0;
+    double value = 0.0;
+    bool hasTrackColor = false;
+    rgb_color trackColor;
+    int textOffset = 0; // into the surface's snapshot text
+    int textSize = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ActionContext
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    // Per instance state only, the rest (including the Action) lives in the shared template -- keep this within a cache line
+    const ActionContextTemplate* const contextTemplate_ = nullptr;
+    Widget* const widget_ = nullptr;
+    Zone* const zone_ = nullptr;
+    Widget* associatedWidget_ = nullptr;
     
-    bool isFeedbackInverted_ = false;
-    double holdDelayAmount_ = 0.0;
     double delayStartTime_ = 0.0;
     double deferredValue_ = 0.0;
     
-    bool shouldUseDisplayStyle_ = false;
-    int displayStyle_ = 0;
-    
-    bool supportsRGB_ = false;
-    vector<rgb_color> RGBValues_;
-    int currentRGBIndex_ = 0;
+    short steppedValuesIndex_ = 0;
+    short accumulatedIncTicks_ = 0;
+    short accumulatedDecTicks_ = 0;
+    short currentRGBIndex_ = 0;
     
-    bool supportsTrackColor_ = false;
-        
-    bool noFeedback_ = false;
+    void MoveSteppedValueIndex(double delta);
+    bool AccumulateAcceleratedTicks(int accelerationIndex, double delta);
     
-    vector<vector<string>> properties_;
+    bool GetTrackColor(rgb_color &color);
+    void UpdateWidget(FeedbackKind kind, int param, double value);
+    void ApplyWidgetValue(const FeedbackSnapshot &snapshot, double value);
     
 public:
-    ActionContext(Action* action, Widget* widget, Zone* zone, vector<string> params, vector<vector<string>> properties);
-    virtual ~ActionContext() {}
+    ActionContext(const ActionContextTemplate* contextTemplate, Widget* widget, Zone* zone);
     
     Widget* GetWidget() { return widget_; }
     Zone* GetZone() { return zone_; }
     int GetSlotIndex();
-    string GetName();
+    const string &GetName();
 
     void SetAssociatedWidget(Widget* widget) { associatedWidget_ = widget; }
     Widget* GetAssociatedWidget() { return associatedWidget_; }
 
-    int GetIntParam() { return intParam_; }
-    string GetStringParam() { return stringParam_; }
-    int GetCommandId() { return commandId_; }
-    bool GetShouldUseDisplayStyle() { return shouldUseDisplayStyle_; }
-    int GetDisplayStyle() { return displayStyle_; }
+    int GetIntParam() { return contextTemplate_->intParam; }
+    const string &GetStringParam() { return contextTemplate_->stringParam; }
+    int GetCommandId() { return contextTemplate_->commandId; }
+    bool GetShouldUseDisplayStyle() { return contextTemplate_->shouldUseDisplayStyle; }
+    int GetDisplayStyle() { return contextTemplate_->displayStyle; }
     
     MediaTrack* GetTrack();
     
@@ -323,75 +719,81 @@ public:
     
     Page* GetPage();
     ControlSurface* GetSurface();
-    int GetParamIndex() { return paramIndex_; }
+    int GetParamIndex() { return contextTemplate_->paramIndex; }
     
-    bool GetSupportsRGB() { return supportsRGB_; }
-    
-    void SetIsFeedbackInverted() { isFeedbackInverted_ = true; }
-    void SetHoldDelayAmount(double holdDelayAmount) { holdDelayAmount_ = holdDelayAmount * 1000.0; } // holdDelayAmount is specified in seconds, holdDelayAmount_ is in milliseconds
+    bool GetSupportsRGB() { return contextTemplate_->supportsRGB; }
+    bool GetShouldCoalesce() { return contextTemplate_->shouldCoalesce; }
     
     void DoAction(double value);
     void DoRelativeAction(double value);
     void DoRelativeAction(int accelerationIndex, double value);
+    void DoRelativeAction(const vector<double> &deltas);
+    void DoRelativeAction(const vector<QueuedAcceleratedRelativeAction> &acceleratedDeltas);
     
     void RequestUpdate();
     void RunDeferredActions();
     void ClearWidget();
     void UpdateWidgetValue(double value);
     void UpdateWidgetValue(int param, double value);
-    void UpdateWidgetValue(string value);
+    void UpdateWidgetValue(const string &value);
+    void UpdateWidgetValue(const char* value);
     void ForceWidgetValue(double value);
     
+    // Raw REAPER values, converted and formatted wherever the update is applied
+    void UpdateWidgetVolume(double volume) { UpdateWidget(FeedbackVolume, 0, volume); }
+    void UpdateWidgetVolumeDB(double volume) { UpdateWidget(FeedbackVolumeDB, 0, volume); }
+    void UpdateWidgetVolumeText(double volume) { UpdateWidget(FeedbackVolumeText, 0, volume); }
+    void UpdateWidgetPanText(double pan) { UpdateWidget(FeedbackPanText, 0, pan); }
+    void UpdateWidgetPanWidthText(double width) { UpdateWidget(FeedbackPanWidthText, 0, width); }
+    
+    void ApplyFeedback(const FeedbackSnapshot &snapshot, const char* text, int textSize);
+    
     void DoTouch(double value)
     {
-        action_->Touch(this, value);
+        contextTemplate_->action->Touch(this, value);
     }
     
-    string GetFxParamDisplayName()
+    // The name from the zone file, otherwise REAPER's, which goes into the caller's buffer
+    const char* GetFxParamDisplayName(char* buffer, int bufferSize)
     {
-        if(fxParamDisplayName_ != "")
-            return fxParamDisplayName_;
-        else if(MediaTrack* track = GetTrack())
-        {
-            char fxParamName[BUFSZ];
-            DAW::TrackFX_GetParamName(track, GetSlotIndex(), paramIndex_, fxParamName, sizeof(fxParamName));
-            return fxParamName;
-        }
+        if(contextTemplate_->fxParamDisplayName != "")
+            return contextTemplate_->fxParamDisplayName.c_str();
         
-        return "";
-    }
-
-    void SetCurrentRGB(rgb_color newColor)
-    {
-        supportsRGB_ = true;
-        RGBValues_[currentRGBIndex_] = newColor;
+        buffer[0] = 0;
+        
+        if(MediaTrack* track = GetTrack())
+            DAW::TrackFX_GetParamName(track, GetSlotIndex(), contextTemplate_->paramIndex, buffer, bufferSize);
+        
+        return buffer;
     }
     
     rgb_color GetCurrentRGB()
     {
         rgb_color blankColor;
         
-        if(RGBValues_.size() > 0 && currentRGBIndex_ < RGBValues_.size())
-            return RGBValues_[currentRGBIndex_];
+        if(contextTemplate_->RGBValues.size() > 0 && currentRGBIndex_ < (int)contextTemplate_->RGBValues.size())
+            return contextTemplate_->RGBValues[currentRGBIndex_];
         else return blankColor;
     }
     
     void SetSteppedValueIndex(double value)
     {
+        const vector<double> &steppedValues = contextTemplate_->steppedValues;
+        
         int index = 0;
         double delta = 100000000.0;
         
-        for(int i = 0; i < steppedValues_.size(); i++)
-            if(abs(steppedValues_[i] - value) < delta)
+        for(int i = 0; i < (int)steppedValues.size(); i++)
+            if(abs(steppedValues[i] - value) < delta)
             {
-                delta = abs(steppedValues_[i] - value);
+                delta = abs(steppedValues[i] - value);
                 index = i;
             }
         
         steppedValuesIndex_ = index;
     }
 
-    string GetPanValueString(double panVal)
+    void GetPanValueString(double panVal, char* trackPanValueString, int bufferSize)
     {
         bool left = false;
         
@@ -402,40 +804,30 @@ public:
         }
         
         int panIntVal = int(panVal * 100.0);
-        string trackPanValueString = "";
         
-        if(left)
+        if(panIntVal == 0)
+            snprintf(trackPanValueString, bufferSize, "  <C>  ");
+        else if(left)
         {
             if(panIntVal == 100)
-                trackPanValueString += "<";
+                snprintf(trackPanValueString, bufferSize, "<%d", panIntVal);
             else if(panIntVal < 100 && panIntVal > 9)
-                trackPanValueString += "< ";
+                snprintf(trackPanValueString, bufferSize, "< %d", panIntVal);
             else
-                trackPanValueString += "<  ";
-            
-            trackPanValueString += to_string(panIntVal);
+                snprintf(trackPanValueString, bufferSize, "<  %d", panIntVal);
         }
         else
         {
-            trackPanValueString += "   ";
-            
-            trackPanValueString += to_string(panIntVal);
-            
             if(panIntVal == 100)
-                trackPanValueString += ">";
+                snprintf(trackPanValueString, bufferSize, "   %d>", panIntVal);
             else if(panIntVal < 100 && panIntVal > 9)
-                trackPanValueString += " >";
+                snprintf(trackPanValueString, bufferSize, "   %d >", panIntVal);
             else
-                trackPanValueString += "  >";
+                snprintf(trackPanValueString, bufferSize, "   %d  >", panIntVal);
         }
-        
-        if(panIntVal == 0)
-            trackPanValueString = "  <C>  ";
-
-        return trackPanValueString;
     }
     
-    string GetPanWidthValueString(double widthVal)
+    void GetPanWidthValueString(double widthVal, char* trackPanWidthString, int bufferSize)
     {
         bool reversed = false;
         
@@ -446,57 +838,166 @@ public:
         }
         
         int widthIntVal = int(widthVal * 100.0);
-        string trackPanWidthString = "";
-        
-        if(reversed)
-            trackPanWidthString += "Rev ";
-        
-        trackPanWidthString += to_string(widthIntVal);
         
         if(widthIntVal == 0)
-            trackPanWidthString = " <Mno> ";
+            snprintf(trackPanWidthString, bufferSize, " <Mno> ");
+        else
+            snprintf(trackPanWidthString, bufferSize, reversed ? "Rev %d" : "%d", widthIntVal);
+    }
+};
 
-        return trackPanWidthString;
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ActionTemplate
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    string actionName;
+    vector<string> params;
+    vector<vector<string>> properties;
+    bool isFeedbackInverted;
+    double holdDelayAmount;
+    bool isChannelInvariant = true;
+    ActionContextTemplate* contextTemplate = nullptr;
+    
+    ActionTemplate(string action, vector<string> prams, bool isInverted, double amount) : actionName(action), params(prams), isFeedbackInverted(isInverted), holdDelayAmount(amount)
+    {
+        isChannelInvariant = actionName.find('|') == string::npos;
+        
+        for(auto param : params)
+            if(param.find('|') != string::npos)
+                isChannelInvariant = false;
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ZoneWidgetTemplate
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    struct ModifierActions
+    {
+        int modifierFlags = 0;
+        bool isTouch = false;
+        int firstContext = 0; // from the widget's first context in each Zone
+        vector<ActionTemplate*> actions;
+    };
+    
+    string widgetName = ""; // can hold the '|' channel placeholder
+    int touchWidgetIndex = -1; // the widget whose touch selects the touch actions, -1 if there is none
+    bool isTouchRelease = false;
+    int numContexts = 0;
+    vector<ModifierActions> modifierActions;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ZoneTemplate
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // One parsed Zone definition, channel Zones (TrackNavigator etc.) share it and substitute their channel number when first used
+    string name = "";
+    string alias = "";
+    string sourceFilePath = "";
+    NavigationStyle navigationStyle = Standard;
+    bool isChannelZone = false;
+    vector<ZoneWidgetTemplate> widgets;
+    
+    ZoneTemplate() {}
+    ZoneTemplate(const ZoneTemplate &) = delete;
+    ZoneTemplate &operator=(const ZoneTemplate &) = delete;
+    
+    ~ZoneTemplate()
+    {
+        for(auto &widget : widgets)
+            for(auto &modifierActions : widget.modifierActions)
+                for(auto action : modifierActions.actions)
+                    delete action;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ActionContexts
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // The contexts a widget uses for the current modifiers and touch state, they live in the Zone
+private:
+    ActionContext* begin_ = nullptr;
+    ActionContext* end_ = nullptr;
+    
+public:
+    ActionContexts() {}
+    ActionContexts(ActionContext* begin, size_t size) : begin_(begin), end_(begin + size) {}
+    
+    ActionContext* begin() { return begin_; }
+    ActionContext* end() { return end_; }
+    size_t size() { return end_ - begin_; }
+    ActionContext &operator[](size_t index) { return begin_[index]; }
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Zone
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
 private:
     ControlSurface* const surface_ = nullptr;
+    const ZoneTemplate* zoneTemplate_ = nullptr;
     Navigator* navigator_= nullptr;
     string const name_ = "";
-    string const alias_ = "";
-    string const sourceFilePath_ = "";
-    
-    map<string, string> touchIds_;
-        
-    map<string, bool> activeTouchIds_;
-    
-    NavigationStyle const navigationStyle_ = Standard;
+    int const channel_ = 0; // substituted for '|' in the template
     
     int slotIndex_ = 0;
 
-    vector<Widget*> widgets_;
-    
     vector<Zone*> includedZones_;
     vector<Zone*> subZones_;
-
-    map<Widget*, map<string, vector<ActionContext>>> actionContextDictionary_;
-    vector<ActionContext> defaultContexts_;
     
-public:   
-    Zone(ControlSurface* surface, Navigator* navigator, NavigationStyle navigationStyle, int slotIndex, map<string, string> touchIds, string name, string alias, string sourceFilePath): surface_(surface), navigator_(navigator), navigationStyle_(navigationStyle), slotIndex_(slotIndex), touchIds_(touchIds), name_(name), alias_(alias), sourceFilePath_(sourceFilePath) {}
-    Zone() {}
+    // Built from the template the first time the Zone is used
+    bool isResolved_ = false;
+    vector<Widget*> widgets_;
+    vector<int> widgetTemplateIndices_;
+    vector<int> widgetFirstContexts_;
+    vector<ActionContext> actionContexts_;
+    vector<signed char> touchStates_; // per template widget, -1 until first touched
+    
+    void Resolve();
+    
+    int GetWidgetIndex(Widget* widget)
+    {
+        for(int i = 0; i < (int)widgets_.size(); i++)
+            if(widgets_[i] == widget)
+                return i;
+        
+        return -1;
+    }
+    
+public:
+    Zone(ControlSurface* surface, const ZoneTemplate* zoneTemplate, Navigator* navigator, int channel, string name): surface_(surface), zoneTemplate_(zoneTemplate), navigator_(navigator), name_(name), channel_(channel), slotIndex_(channel) {}
+    
+    // A hot reloaded file refills its zones in place, everything holding a pointer to them stays valid
+    void Reset(const ZoneTemplate* zoneTemplate, Navigator* navigator)
+    {
+        zoneTemplate_ = zoneTemplate;
+        navigator_ = navigator;
+        includedZones_.clear();
+        subZones_.clear();
+        isResolved_ = false;
+        widgets_.clear();
+        widgetTemplateIndices_.clear();
+        widgetFirstContexts_.clear();
+        actionContexts_.clear();
+        touchStates_.clear();
+    }
+    
+    const string &GetSourceFilePath() { return zoneTemplate_->sourceFilePath; }
+    
+    vector<Widget*> &GetWidgets()
+    {
+        Resolve();
+        return widgets_;
+    }
     
     void Activate();
     void Activate(vector<Zone*> *activeZones);
     void Deactivate();
     bool TryActivate(Widget* widget);
     int GetSlotIndex();
-    vector<ActionContext> &GetActionContexts(Widget* widget);
+    ActionContexts GetActionContexts(Widget* widget);
 
     Navigator* GetNavigator() { return navigator_; }
     void SetNavigator(Navigator* navigator) { navigator_ = navigator; }
@@ -517,31 +1018,23 @@ public:
         subZones_.push_back(subZone);
     }
 
-    string GetName()
+    const string &GetName()
     {
         return name_;
     }
     
-    string GetNameOrAlias()
+    const string &GetNameOrAlias()
     {
-        if(alias_ != "")
-            return alias_;
+        if(zoneTemplate_->alias != "")
+            return zoneTemplate_->alias;
         else
             return name_;
     }
     
-    void AddWidget(Widget* widget)
-    {
-        widgets_.push_back(widget);
-    }
-    
-    void AddActionContext(Widget* widget, string modifier, ActionContext actionContext)
-    {
-        actionContextDictionary_[widget][modifier].push_back(actionContext);
-    }
-    
     void RequestUpdate(vector<Widget*> &usedWidgets)
     {
+        Resolve();
+        
         for(auto widget : widgets_)
         {
             if(find(usedWidgets.begin(), usedWidgets.end(), widget) == usedWidgets.end())
@@ -562,11 +1055,14 @@ public:
             context.DoAction(value);
     }
     
-    void DoTouch(Widget* widget, string widgetName, double value)
+    void DoTouch(Widget* widget, double value)
     {
-        activeTouchIds_[widgetName + "Touch"] = value;
-        activeTouchIds_[widgetName + "TouchPress"] = value;
-        activeTouchIds_[widgetName + "TouchRelease"] = ! value;
+        Resolve();
+        
+        int index = GetWidgetIndex(widget);
+        
+        if(index >= 0)
+            touchStates_[widgetTemplateIndices_[index]] = value != 0;
 
         for(auto &context : GetActionContexts(widget))
             context.DoTouch(value);
@@ -583,20 +1079,24 @@ public:
         for(auto &context : GetActionContexts(widget))
             context.DoRelativeAction(accelerationIndex, delta);
     }
+    
+    void DoRelativeAction(Widget* widget, const vector<double> &deltas)
+    {
+        for(auto &context : GetActionContexts(widget))
+            context.DoRelativeAction(deltas);
+    }
+    
+    void DoRelativeAction(Widget* widget, const vector<QueuedAcceleratedRelativeAction> &acceleratedDeltas)
+    {
+        for(auto &context : GetActionContexts(widget))
+            context.DoRelativeAction(acceleratedDeltas);
+    }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Widget
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
-    struct QueuedAcceleratedRelativeAction
-    {
-        QueuedAcceleratedRelativeAction(int idx, double val) : index(idx), delta(val) {}
-        
-        double delta = 0.0;
-        int index = 0;
-    };
-    
 private:
     ControlSurface* const surface_;
     string const name_;
@@ -604,6 +1104,14 @@ private:
     
     bool isModifier_ = false;
     bool isToggled_ = false;
+    bool isPress_ = false;
+    bool isReadingDAW_ = false; // a processor calls REAPER itself, so its updates are never left for a feedback worker
+    
+    // Motor fader echo suppression
+    bool isTouched_ = false;
+    bool shouldResyncFeedback_ = false;
+    bool hasIncomingValue_ = false;
+    double lastIncomingValue_ = 0.0;
     
     vector<double> queuedActionValues_;
     vector<double> queuedRelativeActionValues_;
@@ -614,20 +1122,43 @@ private:
    
 public:
     Widget(ControlSurface* surface, string name);
-    ~Widget();
     
     ControlSurface* GetSurface() { return surface_; }
-    string GetName() { return name_; }
+    const string &GetName() { return name_; }
     bool GetIsModifier() { return isModifier_; }
     void SetIsModifier() { isModifier_ = true; }
+    bool GetIsPress() { return isPress_; }
+    void SetIsPress() { isPress_ = true; }
+    bool GetIsTouched() { return isTouched_; }
+    bool GetIsReadingDAW() { return isReadingDAW_; }
+    bool GetShouldResyncFeedback() { return shouldResyncFeedback_; }
+    
+    // True while the control is touched, or when value (at the device's resolution) is just the echo of what the surface last sent us
+    bool GetShouldSuppressFeedback(double value, double resolution)
+    {
+        if(shouldResyncFeedback_)
+            return false;
+        
+        if(isTouched_)
+            return true;
+        
+        if(hasIncomingValue_ && abs(int(value * resolution) - int(lastIncomingValue_ * resolution)) <= 1)
+            return true;
+        
+        hasIncomingValue_ = false; // the DAW has moved on, from here on it's real feedback
+        
+        return false;
+    }
     
     void Toggle() { isToggled_ = ! isToggled_; }
     bool GetIsToggled() { return isToggled_; }
+    
+    unsigned long long GetNumFeedbackDedupeHits();
 
     void SetProperties(vector<vector<string>> properties);
     void UpdateValue(double value);
     void UpdateValue(int mode, double value);
-    void UpdateValue(string value);
+    void UpdateValue(const string &value);
     void UpdateRGBValue(int r, int g, int b);
     void ForceValue(double value);
     void ForceRGBValue(int r, int g, int b);
@@ -654,10 +1185,7 @@ public:
         queuedTouchActionValues_.clear();
     }
     
-    void AddFeedbackProcessor(FeedbackProcessor* feedbackProcessor)
-    {
-        feedbackProcessors_.push_back(feedbackProcessor);
-    }
+    void AddFeedbackProcessor(FeedbackProcessor* feedbackProcessor);
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -714,47 +1242,86 @@ protected:
     int lastRValue = 0;
     int lastGValue = 0;
     int lastBValue = 0;
+    
+    unsigned long long numDedupeHits_ = 0;
+    int lastStep_ = -1; // what a processor with a fixed resolution last sent, -1 when unknown
 
     Widget* const widget_ = nullptr;
     
+    // The step the device will show for value, -1 when the processor has no fixed resolution
+    virtual int Quantize(double value) { return -1; }
+    
+    bool GetIsShowingStep(int step)
+    {
+        if(step == lastStep_)
+        {
+            numDedupeHits_++;
+            return true;
+        }
+        
+        lastStep_ = step;
+        return false;
+    }
+    
+    bool GetIsShowingValue(double value)
+    {
+        int step = Quantize(value);
+        
+        if(step >= 0)
+            return GetIsShowingStep(step);
+        
+        if((float)value == (float)lastDoubleValue_) // nothing downstream carries more than a float
+        {
+            numDedupeHits_++;
+            return true;
+        }
+        
+        return false;
+    }
+    
 public:
     FeedbackProcessor(Widget* widget) : widget_(widget) {}
     virtual ~FeedbackProcessor() {}
     Widget* GetWidget() { return widget_; }
+    unsigned long long GetNumDedupeHits() { return numDedupeHits_; }
     virtual void SetRGBValue(int r, int g, int b) {}
     virtual void ForceValue() {}
     virtual void ForceValue(double value) {}
     virtual void ForceValue(int param, double value) {}
     virtual void ForceRGBValue(int r, int g, int b) {}
-    virtual void ForceValue(string value) {}
+    virtual void ForceValue(const string &value) {}
     virtual void SetColors(rgb_color textColor, rgb_color textBackground) {}
     virtual void SetCurrentColor(double value) {}
     virtual void SetProperties(vector<vector<string>> properties) {}
 
     virtual int GetMaxCharacters() { return 0; }
+    virtual bool GetIsReadingDAW() { return false; } // true when SetValue calls REAPER
     
     virtual void SetValue(double value)
     {
-        if(lastDoubleValue_ != value)
+        if( ! GetIsShowingValue(value))
             ForceValue(value);
     }
     
     virtual void SetValue(int param, double value)
     {
-        if(lastDoubleValue_ != value)
+        if( ! GetIsShowingValue(value))
             ForceValue(value);
     }
     
-    virtual void SetValue(string value)
+    virtual void SetValue(const string &value)
     {
         if(lastStringValue_ != value)
             ForceValue(value);
+        else
+            numDedupeHits_++;
     }
 
     virtual void ClearCache()
     {
-        lastDoubleValue_ = 0.0;
-        lastStringValue_ = "";
+        lastDoubleValue_ = -1.0;
+        lastStringValue_ = " ";
+        lastStep_ = -1;
     }
     
     virtual void Clear()
@@ -781,9 +1348,12 @@ class Midi_FeedbackProcessor : public FeedbackProcessor
 protected:
     Midi_ControlSurface* const surface_ = nullptr;
     
-    MIDI_event_ex_t* lastMessageSent_ = new MIDI_event_ex_t(0, 0, 0);
-    MIDI_event_ex_t* midiFeedbackMessage1_ = new MIDI_event_ex_t(0, 0, 0);
-    MIDI_event_ex_t* midiFeedbackMessage2_ = new MIDI_event_ex_t(0, 0, 0);
+    // Messages parsed from the template live in the surface's arena, the defaults live here
+    MIDI_event_ex_t defaultMessages_[3] = { MIDI_event_ex_t(0, 0, 0), MIDI_event_ex_t(0, 0, 0), MIDI_event_ex_t(0, 0, 0) };
+    
+    MIDI_event_ex_t* lastMessageSent_ = &defaultMessages_[0];
+    MIDI_event_ex_t* midiFeedbackMessage1_ = &defaultMessages_[1];
+    MIDI_event_ex_t* midiFeedbackMessage2_ = &defaultMessages_[2];
     
     Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget) : FeedbackProcessor(widget), surface_(surface) {}
     Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : FeedbackProcessor(widget), surface_(surface), midiFeedbackMessage1_(feedback1) {}
@@ -792,33 +1362,57 @@ protected:
     void SendMidiMessage(MIDI_event_ex_t* midiMessage);
     void SendMidiMessage(int first, int second, int third);
     void ForceMidiMessage(int first, int second, int third);
+    void QueueRGBValue(int r, int g, int b);
 
 public:
+    virtual int GetOutputPriority() { return MidiOutputPriorityState; }
+    
+    // Colours queued with the surface go out together at the end of its update, devices that take
+    // several pads per sysex fill in the header and their pad's entry and get merged, the rest send their own
+    virtual int GetColorSysExHeader(unsigned char* header) { return 0; }
+    virtual int GetColorSysExEntry(int r, int g, int b, unsigned char* entry) { return 0; }
+    virtual void SendRGBValue(int r, int g, int b) {}
+    
     virtual void ClearCache() override
     {
         lastMessageSent_->midi_message[0] = 0;
         lastMessageSent_->midi_message[1] = 0;
         lastMessageSent_->midi_message[2] = 0;
+        lastStep_ = -1;
     }
 };
 
+enum OSCColorFormat
+{
+    OSCColorSeparate, // /rColor, /gColor and /bColor, one message each
+    OSCColorInts,     // /Color with three int args
+    OSCColorRGBA      // /Color with one 'r' arg
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class OSC_FeedbackProcessor : public FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
 protected:
     OSC_ControlSurface* const surface_ = nullptr;
-    string oscAddress_ = "";
+    string const oscAddress_;
+    OSCColorFormat const colorFormat_;
+    
+    // built once here rather than on every send
+    string const rColorAddress_;
+    string const gColorAddress_;
+    string const bColorAddress_;
+    string const colorAddress_;
     
 public:
     
-    OSC_FeedbackProcessor(OSC_ControlSurface* surface, Widget* widget, string oscAddress) : FeedbackProcessor(widget), surface_(surface), oscAddress_(oscAddress) {}
+    OSC_FeedbackProcessor(OSC_ControlSurface* surface, Widget* widget, string oscAddress, OSCColorFormat colorFormat = OSCColorSeparate) : FeedbackProcessor(widget), surface_(surface), oscAddress_(oscAddress), colorFormat_(colorFormat), rColorAddress_(oscAddress + "/rColor"), gColorAddress_(oscAddress + "/gColor"), bColorAddress_(oscAddress + "/bColor"), colorAddress_(oscAddress + "/Color") {}
     ~OSC_FeedbackProcessor() {}
 
     virtual void SetRGBValue(int r, int g, int b) override;
     virtual void ForceValue(double value) override;
     virtual void ForceValue(int param, double value) override;
-    virtual void ForceValue(string value) override;
+    virtual void ForceValue(const string &value) override;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -834,6 +1428,11 @@ protected:
 
     Zone* homeZone_ = nullptr;
     
+    double inputTimestamp_ = 0.0;
+    
+    SurfaceStats stats_;
+    PortStats* outputPortStats_ = nullptr; // shared with every surface on the same port or socket
+    
     map<string, CSIMessageGenerator*> CSIMessageGeneratorsByMessage_;
     
     vector<Zone*> activeFocusedFXZones_;
@@ -862,6 +1461,9 @@ protected:
     }
     
     string const zoneFolder_ = "";
+    bool isOnline_ = false;
+    string filesStamp_ = ""; // of the template and zone files it was built from
+    bool isStale_ = false; // its files changed while it was running, the next reset rebuilds it
     int const numChannels_ = 0;
     int const numSends_ = 0;
     int const numFXSlots_ = 0;
@@ -889,18 +1491,30 @@ protected:
 
     map<int, Navigator*> navigators_;
     
+    SurfaceArena arena_; // objects that live exactly as long as the surface
+    
     vector<Widget*> widgets_;
     map<string, Widget*> widgetsByName_;
+    vector<Widget*> usedWidgets_; // the widgets an update reached, kept between updates so it is not reallocated every frame
+    string displayText_; // C string feedback on its way to a widget, kept so its buffer is reused
+    
+    bool isSnapshottingFeedback_ = false;
+    vector<FeedbackSnapshot> feedbackSnapshots_; // this update's, kept so they aren't reallocated every frame
+    string feedbackText_; // the snapshots' text, back to back
 
-    virtual void SurfaceOutMonitor(Widget* widget, string address, string value);
+    virtual void SurfaceOutMonitor(Widget* widget, const string &address, const string &value);
 
     void InitZones(string zoneFolder);
 
     map<string, string> zoneFilenames_;
     map<string, Zone*> zonesByName_;
     vector<Zone*> zones_;
+    map<string, ZoneTemplate*> zoneTemplates_; // by Zone name, shared by every Zone expanded from it
+    vector<ZoneTemplate*> replacedZoneTemplates_; // by a reload, zones that weren't refilled still use them
+    
+    bool hasFocusedFXZones_ = false;
     
-    void MapFocusedFXToWidgets();
+    void MapFocusedFXToWidgets(int trackNumber, int fxSlot);
     void UnmapFocusedFXFromWidgets();
 
     void MapSelectedTrackFXSlotToWidgets(vector<Zone*> *activeZones, int fxSlot);
@@ -908,36 +1522,58 @@ protected:
     
     void GoZone(vector<Zone*> *activeZones, string zoneName, double value);
     
+    virtual void InitWidgets() {}
+    
     virtual void InitHardwiredWidgets()
     {
         // Add the "hardwired" widgets
-        AddWidget(new Widget(this, "OnTrackSelection"));
-        AddWidget(new Widget(this, "OnPageEnter"));
-        AddWidget(new Widget(this, "OnPageLeave"));
-        AddWidget(new Widget(this, "OnInitialization"));
+        AddWidget(arena_.New<Widget>(this, "OnTrackSelection"));
+        AddWidget(arena_.New<Widget>(this, "OnPageEnter"));
+        AddWidget(arena_.New<Widget>(this, "OnPageLeave"));
+        AddWidget(arena_.New<Widget>(this, "OnInitialization"));
     }
     
 public:
     virtual ~ControlSurface()
     {
-        for(auto [key, messageGenerator] : CSIMessageGeneratorsByMessage_)
-        {
-            delete messageGenerator;
-            messageGenerator = nullptr;
-        }
+        // Widgets, feedback processors, message generators and zones are all in arena_
+        arena_.Release();
         
-        for(auto widget : widgets_)
-        {
-            delete widget;
-            widget = nullptr;
-        }
+        for(auto [name, zoneTemplate] : zoneTemplates_)
+            delete zoneTemplate;
+        
+        for(auto zoneTemplate : replacedZoneTemplates_)
+            delete zoneTemplate;
     };
     
     Page* GetPage() { return page_; }
-    string GetName() { return name_; }
+    SurfaceArena &GetArena() { return arena_; }
+    SurfaceStats &GetStats() { return stats_; }
+    void SetOutputPortStats(PortStats* outputPortStats) { outputPortStats_ = outputPortStats; }
+    unsigned long long GetNumFeedbackDedupeHits();
+    
+    void CountMessageSent(int numBytes)
+    {
+        stats_.numMessagesSent++;
+        stats_.numBytesSent += numBytes;
+        
+        if(outputPortStats_)
+        {
+            outputPortStats_->numMessagesSent++;
+            outputPortStats_->numBytesSent += numBytes;
+        }
+    }
+    
+    virtual int GetInputQueueDepth() { return 0; }
+    virtual int GetNumDroppedMessages() { return 0; }
+    virtual int GetNumOverflowedRuns() { return 0; }
+    double GetInputTimestamp() { return inputTimestamp_; } // arrival time of the message currently being processed
+    const string &GetName() { return name_; }
     
     virtual string GetSourceFileName() { return ""; }
     vector<Widget*> &GetWidgets() { return widgets_; }
+    vector<Zone*> &GetZones() { return zones_; }
+    string &GetDisplayText() { return displayText_; }
     
     int GetNumChannels() { return numChannels_; }
     int GetNumSendSlots() { return numSends_; }
@@ -982,6 +1618,8 @@ public:
     
     void LoadZone(string zoneName);
     Zone* GetZone(string zoneName);
+    Zone* GetLoadedZone(string zoneName) { return zonesByName_.count(zoneName) > 0 ? zonesByName_[zoneName] : nullptr; }
+    void ReloadZoneFile(string filePath);
     void GoZone(string zoneName, double value);
     void GoSubZone(Zone* enclosingZone, string zoneName, double value);
     virtual void LoadingZone(string zoneName) {}
@@ -1075,64 +1713,83 @@ public:
         zoneFilenames_[name] = filename;
     }
     
+    void SetHasFocusedFXZones() { hasFocusedFXZones_ = true; }
+    bool GetHasFocusedFXZones() { return hasFocusedFXZones_; }
+    
+    void SetZoneTemplate(ZoneTemplate* zoneTemplate)
+    {
+        // A reloaded definition replaces the old one. Zones the new parse didn't reset, such as channels
+        // that no longer exist, still point at it, so it stays alive as long as the surface does
+        if(zoneTemplates_.count(zoneTemplate->name) > 0 && zoneTemplates_[zoneTemplate->name] != zoneTemplate)
+            replacedZoneTemplates_.push_back(zoneTemplates_[zoneTemplate->name]);
+        
+        zoneTemplates_[zoneTemplate->name] = zoneTemplate;
+    }
+    
     void AddZone(Zone* zone)
     {
+        if(zonesByName_.count(zone->GetName()) > 0) // reloaded in place
+            return;
+        
         zonesByName_[zone->GetName()] = zone;
         zones_.push_back(zone);
     }
        
-    map<int, map<int, int>> focusedFXDictionary;
+    void LoadFocusedFXZone(int trackNumber, int fxSlot);
     
-    void CheckFocusedFXState()
+    void OnFocusedFXChange(int trackNumber, int fxSlot, int focusState)
     {
-        int trackNumber = 0;
-        int itemNumber = 0;
-        int fxIndex = 0;
+        if(focusState == 1)
+            MapFocusedFXToWidgets(trackNumber, fxSlot);
+        
+        else if(focusState & 4)
+            UnmapFocusedFXFromWidgets();
+    }
+    
+    virtual void RequestUpdate()
+    {
+        usedWidgets_.clear();
+
+        for(auto activeZones : allActiveZones_)
+            for(auto zone : *activeZones)
+                zone->RequestUpdate(usedWidgets_);
         
-        int retval = DAW::GetFocusedFX2(&trackNumber, &itemNumber, &fxIndex);
+        if(homeZone_ != nullptr)
+            homeZone_->RequestUpdate(usedWidgets_);
         
-        if((retval & 1) && (fxIndex > -1))
+        for(auto widget : widgets_)
         {
-            int lastRetval = -1;
-
-            if(focusedFXDictionary.count(trackNumber) > 0 && focusedFXDictionary[trackNumber].count(fxIndex) > 0)
-                lastRetval = focusedFXDictionary[trackNumber][fxIndex];
+            auto it = find(usedWidgets_.begin(), usedWidgets_.end(), widget);
             
-            if(lastRetval != retval)
-            {
-                if(retval == 1)
-                    MapFocusedFXToWidgets();
-                
-                else if(retval & 4)
-                    UnmapFocusedFXFromWidgets();
-                
-                if(focusedFXDictionary[trackNumber].count(trackNumber) < 1)
-                    focusedFXDictionary[trackNumber] = map<int, int>();
-                                   
-                focusedFXDictionary[trackNumber][fxIndex] = retval;;
-            }
+            if (it == usedWidgets_.end() )
+                widget->Clear();
         }
     }
     
-    virtual void RequestUpdate()
+    // With feedback workers an update is split in three: SnapshotFeedback is RequestUpdate with the widget updates held back,
+    // ComputeFeedback applies them on a worker, then TransmitFeedback sends what they came to -- the first and last on the main thread
+    virtual bool GetCanComputeFeedback() { return false; }
+    virtual void ComputeFeedback();
+    virtual void TransmitFeedback() {}
+    
+    void SnapshotFeedback()
+    {
+        isSnapshottingFeedback_ = true;
+        RequestUpdate();
+        isSnapshottingFeedback_ = false;
+    }
+    
+    bool GetShouldSnapshotFeedback(Widget* widget) { return isSnapshottingFeedback_ && ! widget->GetIsReadingDAW(); }
+    
+    void AddFeedbackSnapshot(const FeedbackSnapshot &snapshot, const char* text = nullptr, int textSize = 0)
     {
-        CheckFocusedFXState();
+        feedbackSnapshots_.push_back(snapshot);
         
-        vector<Widget*> usedWidgets;
-
-        for(auto activeZones : allActiveZones_)
-            for(auto zone : *activeZones)
-                zone->RequestUpdate(usedWidgets);
-        
-        if(homeZone_ != nullptr)
-            homeZone_->RequestUpdate(usedWidgets);
-        
-        for(auto widget : widgets_)
+        if(textSize > 0)
         {
-            auto it = find(usedWidgets.begin(), usedWidgets.end(), widget);
-            
-            if (it == usedWidgets.end() )
-                widget->Clear();
+            feedbackSnapshots_.back().textOffset = (int)feedbackText_.size();
+            feedbackSnapshots_.back().textSize = textSize;
+            feedbackText_.append(text, textSize);
         }
     }
 
@@ -1145,12 +1802,7 @@ public:
     void ClearCache()
     {
         for(auto widget : widgets_)
-        {
-            widget->UpdateValue(0.0);
-            widget->UpdateValue(0, 0.0);
-            widget->UpdateValue("");
             widget->ClearCache();
-        }
     }
     
     void AddWidget(Widget* widget)
@@ -1189,6 +1841,23 @@ public:
         if(widgetsByName_.count("OnInitialization") > 0)
             widgetsByName_["OnInitialization"]->QueueAction(1.0);
     }
+    
+    // The template and zones are parsed when the Manager brings the surface online, one surface per Run
+    bool GetAreFilesReady();
+    string GetCurrentFilesStamp(); // from the workers' reads, call once GetAreFilesReady
+    
+    void BringOnline()
+    {
+        isOnline_ = true;
+        filesStamp_ = GetCurrentFilesStamp();
+        InitWidgets();
+        OnInitialization();
+    }
+    
+    bool GetIsOnline() { return isOnline_; }
+    const string &GetFilesStamp() { return filesStamp_; }
+    void SetIsStale() { isStale_ = true; }
+    bool GetIsStale() { return isStale_; }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1199,15 +1868,66 @@ private:
     string templateFilename_ = "";
     midi_Input* midiInput_ = nullptr;
     midi_Output* midiOutput_ = nullptr;
+    MidiInputQueue* const midiInputQueue_ = nullptr;
+    MidiOutputQueue* const midiOutputQueue_ = nullptr;
+    MidiDeviceState* const deviceState_ = nullptr;
     map<int, vector<Midi_CSIMessageGenerator*>> Midi_CSIMessageGeneratorsByMessage_;
     
+    struct QueuedColor
+    {
+        Midi_FeedbackProcessor* processor = nullptr;
+        int r = 0;
+        int g = 0;
+        int b = 0;
+        bool isMerged = false;
+        bool isSent = true;
+    };
+    
+    vector<QueuedColor> colorBatch_;
+    set<unsigned long long> colorBatchKeys_; // one per device header and set of pads, stable for as long as the surface lives
+    
+    void SendColorBatch();
+    void SendColorSysEx(MIDI_event_ex_t* evt, int headerSize, int start, int end);
+    
+    vector<Midi_FeedbackProcessor*> unsentSources_; // lost a message to a full output queue this update
+    
+    void AddUnsentSource(Midi_FeedbackProcessor* source);
+    void ClearUnsentSources();
+    
+    // key stands in for the processor, a newer message with the same key and address replaces one still waiting to go out
+    bool SendReplaceableMidiMessage(MIDI_event_ex_t* midiMessage, const void* key, int priority);
+    
+    // Sends made while a feedback worker computes the update, TransmitFeedback puts them through the calls they came from
+    enum HeldMidiMessageType
+    {
+        HeldMidiEvent,
+        HeldMidiShort,
+        HeldMidiChanged
+    };
+    
+    struct HeldMidiMessage
+    {
+        HeldMidiMessageType type = HeldMidiEvent;
+        Midi_FeedbackProcessor* source = nullptr;
+        int priority = MidiOutputPriorityState;
+        int offset = 0; // into heldBytes_
+        int size = 0;
+    };
+    
+    bool isHoldingSends_ = false;
+    vector<HeldMidiMessage> heldMessages_;
+    vector<unsigned char> heldBytes_;
+    vector<unsigned char> heldEvent_; // a MIDI_event_ex_t long enough for the held message being sent
+    
+    void HoldMidiMessage(HeldMidiMessageType type, const unsigned char* bytes, int size, Midi_FeedbackProcessor* source, int priority);
+    
     // special processing for MCU meters
     bool hasMCUMeters_ = false;
     int displayType_ = 0x14;
     
     void ProcessMidiMessage(const MIDI_event_ex_t* evt);
    
-    void InitWidgets(string templateFilename, string zoneFolder);
+    virtual void InitWidgets() override;
 
     void InitializeMCU();
     void InitializeMCUXT();
@@ -1224,18 +1944,39 @@ private:
     }
 
 public:
-    Midi_ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, const string name, string templateFilename, string zoneFolder, int numChannels, int numSends, int numFX, int channelOffset, midi_Input* midiInput, midi_Output* midiOutput)
-    : ControlSurface(CSurfIntegrator, page, name, zoneFolder, numChannels, numSends, numFX, channelOffset), templateFilename_(templateFilename), midiInput_(midiInput), midiOutput_(midiOutput)
+    Midi_ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, const string name, string templateFilename, string zoneFolder, int numChannels, int numSends, int numFX, int channelOffset, midi_Input* midiInput, midi_Output* midiOutput, MidiInputQueue* midiInputQueue, MidiOutputQueue* midiOutputQueue, MidiDeviceState* deviceState)
+    : ControlSurface(CSurfIntegrator, page, name, zoneFolder, numChannels, numSends, numFX, channelOffset), templateFilename_(templateFilename), midiInput_(midiInput), midiOutput_(midiOutput), midiInputQueue_(midiInputQueue), midiOutputQueue_(midiOutputQueue), deviceState_(deviceState)
+    {}
+    
+    virtual ~Midi_ControlSurface();
+    
+    virtual string GetSourceFileName() override { return "/CSI/Surfaces/Midi/" + templateFilename_; }
+    
+    bool SendMidiMessage(MIDI_event_ex_t* midiMessage, Midi_FeedbackProcessor* source = nullptr);
+    bool SendMidiMessage(MIDI_event_ex_t* midiMessage, Midi_FeedbackProcessor* source, int priority);
+    bool SendMidiMessage(int first, int second, int third, Midi_FeedbackProcessor* source = nullptr);
+    void SendChangedMidiMessage(int first, int second, int third, Midi_FeedbackProcessor* source = nullptr);
+    void QueueRGBValue(Midi_FeedbackProcessor* processor, int r, int g, int b);
+    
+    virtual void RequestUpdate() override
     {
-        InitWidgets(templateFilename, zoneFolder);
+        ClearUnsentSources();
+        ControlSurface::RequestUpdate();
+        
+        if( ! isSnapshottingFeedback_) // otherwise TransmitFeedback sends them
+            SendColorBatch();
     }
     
-    virtual ~Midi_ControlSurface() {}
+    virtual bool GetCanComputeFeedback() override { return true; }
     
-    virtual string GetSourceFileName() override { return "/CSI/Surfaces/Midi/" + templateFilename_; }
+    virtual void ComputeFeedback() override
+    {
+        isHoldingSends_ = true;
+        ControlSurface::ComputeFeedback();
+        isHoldingSends_ = false;
+    }
     
-    void SendMidiMessage(MIDI_event_ex_t* midiMessage);
-    void SendMidiMessage(int first, int second, int third);
+    virtual void TransmitFeedback() override;
 
     virtual void SetHasMCUMeters(int displayType) override
     {
@@ -1245,9 +1986,20 @@ public:
     
     virtual void HandleExternalInput() override
     {
-        if(midiInput_)
+        if(midiInputQueue_) // the port's input thread has already drained the device
+        {
+            TimestampedMidiEvent timestampedEvent;
+            
+            while(midiInputQueue_->Pop(timestampedEvent))
+            {
+                inputTimestamp_ = timestampedEvent.timestamp;
+                ProcessMidiMessage(&timestampedEvent.event);
+            }
+        }
+        else if(midiInput_)
         {
             DAW::SwapBufsPrecise(midiInput_);
+            inputTimestamp_ = DAW::GetPreciseNumberOfMilliseconds();
             MIDI_eventlist* list = midiInput_->GetReadBuf();
             int bpos = 0;
             MIDI_event_t* evt;
@@ -1260,6 +2012,17 @@ public:
     {
         Midi_CSIMessageGeneratorsByMessage_[message].push_back(messageGenerator);
     }
+    
+    vector<Midi_CSIMessageGenerator*>* GetMessageGenerators(const MIDI_event_ex_t* evt);
+    
+    void GetMappedMessages(vector<int> &messages)
+    {
+        for(auto &[message, generators] : Midi_CSIMessageGeneratorsByMessage_)
+            messages.push_back(message);
+    }
+    
+    virtual int GetNumDroppedMessages() override { return midiInputQueue_ != nullptr ? midiInputQueue_->GetNumDropped() : 0; }
+    virtual int GetInputQueueDepth() override { return midiInputQueue_ != nullptr ? midiInputQueue_->GetSize() : 0; }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1270,26 +2033,30 @@ private:
     string templateFilename_ = "";
     oscpkt::UdpSocket* const inSocket_ = nullptr;
     oscpkt::UdpSocket* const outSocket_ = nullptr;
+    OSCInputQueue* const inputQueue_ = nullptr;
     oscpkt::PacketReader packetReader_;
     oscpkt::PacketWriter packetWriter_;
+    oscpkt::Message outMessage_;
     
-    void InitWidgets(string templateFilename, string zoneFolder);
+    int numOverflowedRuns_ = 0;
+    int numDroppedMessagesReported_ = 0;
+    
+    virtual void InitWidgets() override;
     void ProcessOSCMessage(string message, double value);
 
 public:
-    OSC_ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, const string name, string templateFilename, string zoneFolder, int numChannels, int numSends, int numFX, int channelOffset, oscpkt::UdpSocket* inSocket, oscpkt::UdpSocket* outSocket)
-    : ControlSurface(CSurfIntegrator, page, name, zoneFolder, numChannels, numSends, numFX, channelOffset), templateFilename_(templateFilename), inSocket_(inSocket), outSocket_(outSocket)
-    {
-        InitWidgets(templateFilename, zoneFolder);
-    }
+    OSC_ControlSurface(CSurfIntegrator* CSurfIntegrator, Page* page, const string name, string templateFilename, string zoneFolder, int numChannels, int numSends, int numFX, int channelOffset, oscpkt::UdpSocket* inSocket, oscpkt::UdpSocket* outSocket, OSCInputQueue* inputQueue)
+    : ControlSurface(CSurfIntegrator, page, name, zoneFolder, numChannels, numSends, numFX, channelOffset), templateFilename_(templateFilename), inSocket_(inSocket), outSocket_(outSocket), inputQueue_(inputQueue)
+    {}
     
     virtual ~OSC_ControlSurface() {}
     
     virtual string GetSourceFileName() override { return "/CSI/Surfaces/OSC/" + templateFilename_; }
     
     virtual void LoadingZone(string zoneName) override;
-    void SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, double value);
-    void SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, string oscAddress, string value);
+    void SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, const string &oscAddress, double value);
+    void SendOSCMessage(OSC_FeedbackProcessor* feedbackProcessor, const string &oscAddress, const string &value);
+    void SendOSCColorMessage(OSC_FeedbackProcessor* feedbackProcessor, const string &oscAddress, OSCColorFormat colorFormat, int r, int g, int b);
     
     virtual void ForceClearAllWidgets() override
     {
@@ -1297,28 +2064,11 @@ public:
         ControlSurface::ForceClearAllWidgets();
     }
     
-    virtual void HandleExternalInput() override
-    {
-        if(inSocket_ != nullptr && inSocket_->isOk())
-        {
-            while (inSocket_->receiveNextPacket(0))  // timeout, in ms
-            {
-                packetReader_.init(inSocket_->packetData(), inSocket_->packetSize());
-                oscpkt::Message *message;
-                
-                while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
-                {
-                    float value = 0;
-                    
-                    if(message->arg().isFloat())
-                    {
-                        message->arg().popFloat(value);
-                        ProcessOSCMessage(message->addressPattern(), value);
-                    }
-                }
-            }
-        }
-    }
+    virtual int GetNumOverflowedRuns() override { return numOverflowedRuns_; }
+    virtual int GetNumDroppedMessages() override { return inputQueue_ != nullptr ? inputQueue_->GetNumDropped() : 0; }
+    virtual int GetInputQueueDepth() override { return inputQueue_ != nullptr ? inputQueue_->GetSize() : 0; }
+    
+    virtual void HandleExternalInput() override;
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1433,7 +2183,7 @@ public:
         }
     }
     
-    string GetAutoModeDisplayName()
+    const string &GetAutoModeDisplayName()
     {
         int globalOverride = DAW::GetGlobalAutomationOverride();
 
@@ -1443,7 +2193,7 @@ public:
             return autoModeDisplayNames__[autoModeIndex_];
     }
 
-    string GetAutoModeDisplayName(int modeIndex)
+    const string &GetAutoModeDisplayName(int modeIndex)
     {
         return autoModeDisplayNames__[modeIndex];
     }
@@ -1945,6 +2695,8 @@ class Page
 private:
     string name_ = "";
     vector<ControlSurface*> surfaces_;
+    vector<string> surfaceConfigs_; // the CSI.ini line and files each surface was built from
+    vector<ControlSurface*> computingSurfaces_; // handed to the feedback workers by Run, kept so it isn't reallocated every frame
     
     bool isShift_ = false;
     double shiftPressedTime_ = 0;
@@ -1957,6 +2709,43 @@ private:
     
     TrackNavigationManager* const trackNavigationManager_ = nullptr;
     
+    int focusedFXTrackNumber_ = 0;
+    int focusedFXSlot_ = -1;
+    int focusedFXState_ = 0;
+    bool hasPendingFocusedFXChange_ = false;
+    
+    void CheckFocusedFXState(bool isInBackground = false)
+    {
+        int trackNumber = 0;
+        int itemNumber = 0;
+        int fxSlot = 0;
+        
+        int focusState = DAW::GetFocusedFX2(&trackNumber, &itemNumber, &fxSlot);
+        
+        if((focusState & 1) && fxSlot >= 0 && (focusState != focusedFXState_ || trackNumber != focusedFXTrackNumber_ || fxSlot != focusedFXSlot_))
+        {
+            focusedFXTrackNumber_ = trackNumber;
+            focusedFXSlot_ = fxSlot;
+            focusedFXState_ = focusState;
+            hasPendingFocusedFXChange_ = true;
+            
+            // Activating or deactivating zones reaches the device, an inactive page only parses the FX's zone ahead of time
+            if(isInBackground)
+                for(auto surface : surfaces_)
+                    if(surface->GetIsOnline() && surface->GetHasFocusedFXZones())
+                        surface->LoadFocusedFXZone(trackNumber, fxSlot);
+        }
+        
+        if(isInBackground || ! hasPendingFocusedFXChange_)
+            return;
+        
+        hasPendingFocusedFXChange_ = false;
+        
+        for(auto surface : surfaces_)
+            if(surface->GetIsOnline() && surface->GetHasFocusedFXZones())
+                surface->OnFocusedFXChange(focusedFXTrackNumber_, focusedFXSlot_, focusedFXState_);
+    }
+    
 public:
     Page(string name, bool followMCP, bool synchPages, bool scrollLink, int numChannels) : name_(name),  trackNavigationManager_(new TrackNavigationManager(this, followMCP, synchPages, scrollLink, numChannels)) {}
     
@@ -1971,7 +2760,7 @@ public:
         delete trackNavigationManager_;
     }
     
-    string GetName() { return name_; }
+    const string &GetName() { return name_; }
     
     bool GetShift() { return isShift_; }
     bool GetOption() { return isOption_; }
@@ -2255,13 +3044,96 @@ public:
 
     void Run()
     {
-        trackNavigationManager_->RebuildTrackList();
+        TraceSpan span("Page::Run", name_);
+        
+        {
+            TraceSpan span("RebuildTrackList", name_);
+            trackNavigationManager_->RebuildTrackList();
+        }
         
         for(auto surface : surfaces_)
-            surface->HandleExternalInput();
+        {
+            if(surface->GetIsOnline())
+            {
+                TraceSpan span("HandleExternalInput", surface->GetName());
+                surface->HandleExternalInput();
+            }
+        }
+        
+        {
+            TraceSpan span("CheckFocusedFXState", name_);
+            CheckFocusedFXState();
+        }
+        
+        if(GetNumFeedbackWorkers() == 0)
+        {
+            for(auto surface : surfaces_)
+            {
+                if(surface->GetIsOnline())
+                {
+                    TraceSpan span("RequestUpdate", surface->GetName());
+                    surface->RequestUpdate();
+                }
+            }
+            
+            return;
+        }
+        
+        // Only the REAPER reads are left on the main thread, the workers do the rest of the updates before anything is sent
+        computingSurfaces_.clear();
         
         for(auto surface : surfaces_)
-            surface->RequestUpdate();
+        {
+            if( ! surface->GetIsOnline())
+                continue;
+            
+            TraceSpan span("SnapshotFeedback", surface->GetName());
+            
+            if(surface->GetCanComputeFeedback())
+            {
+                surface->SnapshotFeedback();
+                computingSurfaces_.push_back(surface);
+            }
+            else
+                surface->RequestUpdate();
+        }
+        
+        {
+            TraceSpan span("ComputeFeedback", name_);
+            ComputeFeedback(computingSurfaces_);
+        }
+        
+        for(auto surface : computingSurfaces_)
+        {
+            TraceSpan span("TransmitFeedback", surface->GetName());
+            surface->TransmitFeedback();
+        }
+    }
+    
+    void ReloadZoneFile(string filePath)
+    {
+        for(auto surface : surfaces_)
+            if(surface->GetIsOnline())
+                surface->ReloadZoneFile(filePath);
+    }
+    
+    vector<ControlSurface*> &GetSurfaces() { return surfaces_; }
+    
+    ControlSurface* GetOfflineSurface()
+    {
+        for(auto surface : surfaces_)
+            if( ! surface->GetIsOnline())
+                return surface;
+        
+        return nullptr;
+    }
+
+    // Keeps an inactive page's track list current and its FX zones parsed, nothing is sent to the surfaces,
+    // a focus change seen here is applied by the first Run after the page becomes current again
+    void RefreshInBackground()
+    {
+        trackNavigationManager_->RebuildTrackList();
+        CheckFocusedFXState(true);
     }
 
     void ForceClearAllWidgets()
@@ -2276,9 +3148,37 @@ public:
             surface->ForceRefreshTimeDisplay();
     }
 
-    void AddSurface(ControlSurface* surface)
+    void AddSurface(ControlSurface* surface, const string &config)
     {
         surfaces_.push_back(surface);
+        surfaceConfigs_.push_back(config);
+    }
+    
+    // Hands back the surfaces built from these configs, in the same order with nullptr for any that have to be built, and deletes the rest
+    vector<ControlSurface*> KeepSurfaces(const vector<string> &configs)
+    {
+        vector<ControlSurface*> keptSurfaces(configs.size(), nullptr);
+        
+        for(size_t i = 0; i < configs.size(); i++)
+        {
+            for(size_t j = 0; j < surfaces_.size(); j++)
+            {
+                if(surfaces_[j] != nullptr && ! surfaces_[j]->GetIsStale() && surfaceConfigs_[j] == configs[i])
+                {
+                    keptSurfaces[i] = surfaces_[j];
+                    surfaces_[j] = nullptr;
+                    break;
+                }
+            }
+        }
+        
+        for(auto surface : surfaces_)
+            delete surface;
+        
+        surfaces_.clear();
+        surfaceConfigs_.clear();
+        
+        return keptSurfaces;
     }
     
     bool GetTouchState(MediaTrack* track, int touchedControl)
@@ -2324,20 +3224,9 @@ public:
         }
     }
 
-    string GetModifier()
+    int GetModifierFlags()
     {
-        string modifier = "";
-        
-        if(isShift_)
-            modifier += Shift + "+";
-        if(isOption_)
-            modifier += Option + "+";
-        if(isControl_)
-            modifier +=  Control + "+";
-        if(isAlt_)
-            modifier += Alt + "+";
-        
-        return modifier;
+        return (isShift_ ? ShiftFlag : 0) | (isOption_ ? OptionFlag : 0) | (isControl_ ? ControlFlag : 0) | (isAlt_ ? AltFlag : 0);
     }
     
     void OnTrackSelection()
@@ -2371,6 +3260,8 @@ public:
     {
         trackNavigationManager_->EnterPage();
         
+        // The device kept showing another page, so nothing this page remembers sending can be trusted,
+        // the first RequestUpdate resends everything and the per port device state passes on only what differs
         for(auto surface : surfaces_)
             surface->ClearCache();
         
@@ -2384,15 +3275,6 @@ public:
         
         for(auto surface : surfaces_)
             surface->OnPageLeave();
-
-        for(auto surface : surfaces_)
-            surface->ClearCache();        
-    }
-    
-    void OnInitialization()
-    {
-        for(auto surface : surfaces_)
-            surface->OnInitialization();
     }
     
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2425,11 +3307,89 @@ public:
     MediaTrack* GetSelectedTrack() { return trackNavigationManager_->GetSelectedTrack(); }
     void SetAutoModeIndex() { trackNavigationManager_->SetAutoModeIndex(); }
     void NextAutoMode() { trackNavigationManager_->NextAutoMode(); }
-    string GetAutoModeDisplayName() { return trackNavigationManager_->GetAutoModeDisplayName(); }
-    string GetAutoModeDisplayName(int modeIndex) { return trackNavigationManager_->GetAutoModeDisplayName(modeIndex); }
+    const string &GetAutoModeDisplayName() { return trackNavigationManager_->GetAutoModeDisplayName(); }
+    const string &GetAutoModeDisplayName(int modeIndex) { return trackNavigationManager_->GetAutoModeDisplayName(modeIndex); }
     vector<MediaTrack*> &GetSelectedTracks() { return trackNavigationManager_->GetSelectedTracks(); }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class BenchmarkRunner // times a slice at a time, so benchmarks in the DAW never hold up a Run for long
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    struct Benchmark
+    {
+        string group;
+        string name;
+        long long itemsPerIteration = 0;
+        function<void()> body;
+        bool isWarm = false;
+        long long batchSize = 1;
+        long long numIterations = 0;
+        double elapsed = 0.0; // milliseconds
+    };
+    
+    vector<Benchmark> benchmarks_;
+    size_t currentIndex_ = 0;
+    double const minMilliseconds_ = 200.0;
+    string group_ = "";
+    
+public:
+    BenchmarkRunner(double minMilliseconds) : minMilliseconds_(minMilliseconds) {}
+    
+    // Names the benchmarks added from here on, e.g. with the fixture they run against
+    void SetGroup(const string &group) { group_ = group; }
+    
+    void AddBenchmark(const string &name, long long itemsPerIteration, function<void()> body)
+    {
+        Benchmark benchmark;
+        benchmark.group = group_;
+        benchmark.name = name;
+        benchmark.itemsPerIteration = itemsPerIteration;
+        benchmark.body = body;
+        benchmarks_.push_back(benchmark);
+    }
+    
+    bool GetIsDone() { return currentIndex_ >= benchmarks_.size(); }
+    
+    // Runs batches of the current benchmark, then the next, until maxMilliseconds have gone by
+    void Run(double maxMilliseconds)
+    {
+        double sliceStartTime = DAW::GetPreciseNumberOfMilliseconds();
+        
+        while( ! GetIsDone() && DAW::GetPreciseNumberOfMilliseconds() - sliceStartTime < maxMilliseconds)
+        {
+            Benchmark &benchmark = benchmarks_[currentIndex_];
+            
+            if( ! benchmark.isWarm)
+            {
+                benchmark.body();
+                benchmark.isWarm = true;
+                continue;
+            }
+            
+            double startTime = DAW::GetPreciseNumberOfMilliseconds();
+            
+            for(long long i = 0; i < benchmark.batchSize; i++)
+                benchmark.body();
+            
+            double batchTime = DAW::GetPreciseNumberOfMilliseconds() - startTime;
+            
+            benchmark.numIterations += benchmark.batchSize;
+            benchmark.elapsed += batchTime;
+            
+            if(benchmark.elapsed >= minMilliseconds_)
+                currentIndex_++;
+            else if(batchTime < 0.5) // batches stay well inside a slice
+                benchmark.batchSize *= 2;
+        }
+    }
+    
+    string GetJSON();
+};
+
+const double BenchmarkSliceMilliseconds = 2.0; // per Run while the benchmark action is going
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Manager
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2438,12 +3398,21 @@ private:
     CSurfIntegrator* const CSurfIntegrator_ = nullptr;
 
     map<string, Action*> actions_;
+    map<string, ActionContextTemplate*> actionContextTemplates_;
 
     vector <Page*> pages_;
+    vector<string> pageConfigs_; // the CSI.ini line each page was built from, unchanged pages survive a reset
     
     map<string, map<string, int>> fxParamIndices_;
     
     int currentPageIndex_ = 0;
+    bool hasOfflineSurfaces_ = false;
+    vector<ControlSurface*> keptSurfacesToCheck_; // kept running by the last Init, rebuilt if their files turn out to have changed
+    bool isWatchingFiles_ = false;
+    bool isAnsweringStatsQueries_ = false;
+    bool shouldRefreshInactivePages_ = false;
+    int inactivePageRefreshCountdown_ = 0;
+    int nextInactivePageIndex_ = 0;
     bool surfaceInDisplay_ = false;
     bool surfaceRawInDisplay_ = false;
     bool surfaceOutDisplay_ = false;
@@ -2452,6 +3421,8 @@ private:
 
     bool shouldRun_ = true;
     
+    BenchmarkRunner* benchmarkRunner_ = nullptr;
+    
     int *timeModePtr_ = nullptr;
     int *timeMode2Ptr_ = nullptr;
     int *measOffsPtr_ = nullptr;
@@ -2473,6 +3444,8 @@ private:
 public:
     ~Manager()
     {
+        delete benchmarkRunner_;
+        
         for(auto page : pages_)
         {
             delete page;
@@ -2484,6 +3457,12 @@ public:
             delete action;
             action = nullptr;
         }
+        
+        for(auto [key, contextTemplate] : actionContextTemplates_)
+        {
+            delete contextTemplate;
+            contextTemplate = nullptr;
+        }
     }
     
     Manager(CSurfIntegrator* CSurfIntegrator) : CSurfIntegrator_(CSurfIntegrator)
@@ -2544,12 +3523,34 @@ public:
     double *GetTimeOffsPtr() { return timeOffsPtr_; }
     int GetProjectPanMode() { return *projectPanModePtr_; }
    
-    ActionContext GetActionContext(string actionName, Widget* widget, Zone* zone, vector<string> params, vector<vector<string>> properties)
-    {      
-        if(actions_.count(actionName) > 0)
-            return ActionContext(actions_[actionName], widget, zone, params, properties);
-        else
-            return ActionContext(actions_["NoAction"], widget, zone, params, properties);
+    ActionContextTemplate* GetActionContextTemplate(const string &actionName, const vector<string> &params, const vector<vector<string>> &properties, bool isFeedbackInverted, double holdDelayAmount)
+    {
+        // Identical action lines share one parsed template
+        string key = actionName;
+        
+        for(auto param : params)
+            key += "\x1f" + param;
+        
+        for(auto property : properties)
+        {
+            key += "\x1e";
+            
+            for(auto token : property)
+                key += "\x1f" + token;
+        }
+        
+        key += isFeedbackInverted ? "\x1eInvertFB" : "";
+        key += "\x1e" + to_string(holdDelayAmount);
+        
+        if(actionContextTemplates_.count(key) == 0)
+            actionContextTemplates_[key] = new ActionContextTemplate(actions_.count(actionName) > 0 ? actions_[actionName] : actions_["NoAction"], params, properties, isFeedbackInverted, holdDelayAmount);
+        
+        return actionContextTemplates_[key];
+    }
+    
+    ActionContext GetActionContext(string actionName, Widget* widget, Zone* zone, vector<string> params, vector<vector<string>> properties, bool isFeedbackInverted, double holdDelayAmount)
+    {
+        return ActionContext(GetActionContextTemplate(actionName, params, properties, isFeedbackInverted, holdDelayAmount), widget, zone);
     }
 
     void OnTrackSelection(MediaTrack *track)
@@ -2629,6 +3630,76 @@ public:
                     page->AdjustFXMenuSlotBank(originatingSurface, amount);
     }
     
+    void ReloadChangedFiles();
+    
+    string GetStatsJSON();
+    void WriteStatsSnapshot();
+    void AnswerStatsQueries();
+    void AddBenchmarks(BenchmarkRunner &runner);
+    void RunBenchmarks();
+    void RunBenchmarkSlice();
+    
+    void BringNextSurfaceOnline()
+    {
+        // The current page comes first
+        for(int i = 0; i < (int)pages_.size(); i++)
+        {
+            if(ControlSurface* surface = pages_[(currentPageIndex_ + i) % pages_.size()]->GetOfflineSurface())
+            {
+                if(surface->GetAreFilesReady()) // otherwise try again next Run, the workers are still reading
+                    surface->BringOnline();
+                
+                return;
+            }
+        }
+        
+        hasOfflineSurfaces_ = false;
+    }
+    
+    void CheckKeptSurfaces()
+    {
+        bool isAnySurfaceStale = false;
+        
+        for(size_t i = 0; i < keptSurfacesToCheck_.size(); )
+        {
+            ControlSurface* surface = keptSurfacesToCheck_[i];
+            
+            if( ! surface->GetAreFilesReady()) // the workers are still reading
+            {
+                i++;
+                continue;
+            }
+            
+            if(surface->GetCurrentFilesStamp() != surface->GetFilesStamp())
+            {
+                surface->SetIsStale();
+                isAnySurfaceStale = true;
+            }
+            
+            keptSurfacesToCheck_.erase(keptSurfacesToCheck_.begin() + i);
+        }
+        
+        if(isAnySurfaceStale)
+            Init();
+    }
+    
+    void RefreshNextInactivePage()
+    {
+        inactivePageRefreshCountdown_ = InactivePageRefreshInterval;
+        
+        nextInactivePageIndex_ = (nextInactivePageIndex_ + 1) % pages_.size();
+        
+        if(nextInactivePageIndex_ == currentPageIndex_)
+            nextInactivePageIndex_ = (nextInactivePageIndex_ + 1) % pages_.size();
+        
+        pages_[nextInactivePageIndex_]->RefreshInBackground();
+    }
+    
+    Page* GetCurrentPage()
+    {
+        return pages_.size() > 0 ? pages_[currentPageIndex_] : nullptr;
+    }
+    
     void NextPage()
     {
         if(pages_.size() > 0)
@@ -2738,8 +3809,30 @@ public:
     {
         //int start = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
         
+        if(shouldRun_ && isWatchingFiles_)
+            ReloadChangedFiles();
+        
+        FlushTraceToConsole();
+        
+        if(isAnsweringStatsQueries_)
+            AnswerStatsQueries();
+        
         if(shouldRun_ && pages_.size() > 0)
+        {
+            if(hasOfflineSurfaces_)
+                BringNextSurfaceOnline();
+            
             pages_[currentPageIndex_]->Run();
+            
+            if(shouldRefreshInactivePages_ && pages_.size() > 1 && --inactivePageRefreshCountdown_ <= 0)
+                RefreshNextInactivePage();
+            
+            if(keptSurfacesToCheck_.size() > 0) // last, it may reset
+                CheckKeptSurfaces();
+        }
+        
+        if(benchmarkRunner_ != nullptr)
+            RunBenchmarkSlice();
         /*
          repeats++;
          
@@ -7,6 +7,7 @@
 #ifndef control_surface_integrator_Reaper_h
 #define control_surface_integrator_Reaper_h
 
+#include <chrono>
 #include "reaper_plugin_functions.h"
 #include "WDL/mutex.h"
 #include "ReportLoggingEtc.h"
@@ -73,6 +74,11 @@ public:
     #endif
     }
     
+    static double GetPreciseNumberOfMilliseconds()
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
     static void MarkProjectDirty(ReaProject* proj) { ::MarkProjectDirty(proj); }
     
     static const char* get_ini_file() { return ::get_ini_file(); }
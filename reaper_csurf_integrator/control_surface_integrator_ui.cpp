@@ -17,6 +17,9 @@ extern int g_registered_command_toggle_show_surface_input;
 extern int g_registered_command_toggle_show_surface_output;
 extern int g_registered_command_toggle_show_FX_params;
 extern int g_registered_command_toggle_write_FX_params;
+extern int g_registered_command_toggle_capture_trace;
+extern int g_registered_command_write_stats;
+extern int g_registered_command_run_benchmarks;
 
 bool hookCommandProc(int command, int flag)
 {
@@ -47,6 +50,21 @@ bool hookCommandProc(int command, int flag)
             TheManager->ToggleFXParamsWrite();
             return true;
         }
+        else if (command == g_registered_command_toggle_capture_trace)
+        {
+            ToggleTraceCapture();
+            return true;
+        }
+        else if (command == g_registered_command_write_stats)
+        {
+            TheManager->WriteStatsSnapshot();
+            return true;
+        }
+        else if (command == g_registered_command_run_benchmarks)
+        {
+            TheManager->RunBenchmarks();
+            return true;
+        }
     }
     return false;
 }
@@ -24,11 +24,13 @@ public:
     virtual ~PressRelease_Midi_CSIMessageGenerator() {}
     PressRelease_Midi_CSIMessageGenerator(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* press) : Midi_CSIMessageGenerator(widget), press_(press)
     {
+        widget->SetIsPress();
         surface->AddCSIMessageGenerator(press->midi_message[0] * 0x10000 + press->midi_message[1] * 0x100 + press->midi_message[2], this);
     }
     
     PressRelease_Midi_CSIMessageGenerator(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* press, MIDI_event_ex_t* release) : Midi_CSIMessageGenerator(widget), press_(press), release_(release)
     {
+        widget->SetIsPress();
         surface->AddCSIMessageGenerator(press->midi_message[0] * 0x10000 + press->midi_message[1] * 0x100 + press->midi_message[2], this);
         surface->AddCSIMessageGenerator(release->midi_message[0] * 0x10000 + release->midi_message[1] * 0x100 + release->midi_message[2], this);
     }
@@ -95,6 +97,7 @@ public:
     virtual ~AnyPress_Midi_CSIMessageGenerator() {}
     AnyPress_Midi_CSIMessageGenerator(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* press) : Midi_CSIMessageGenerator(widget), press_(press)
     {
+        widget->SetIsPress();
         surface->AddCSIMessageGenerator(press->midi_message[0] * 0x10000 + press->midi_message[1] * 0x100, this);
     }
     
@@ -138,13 +141,47 @@ public:
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct EncoderAccelerationTable
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Compiled at template load, the raw data2 byte indexes straight into (delta, accelerationIndex)
+    struct Entry
+    {
+        double delta = 0.0;
+        int accelerationIndex = -1; // -1 -> value is not part of the spec, ignore it
+    };
+    
+    Entry entries[128];
+    
+    void Set(int value, int accelerationIndex, double delta)
+    {
+        if(value >= 0 && value < 128)
+        {
+            entries[value].accelerationIndex = accelerationIndex;
+            entries[value].delta = delta;
+        }
+    }
+    
+    const Entry &Get(int value) const { return entries[value & 0x7f]; }
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class AcceleratedEncoder_Midi_CSIMessageGenerator : public Midi_CSIMessageGenerator
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
 private:
-    map<int, int> accelerationIndicesForIncrement_;
-    map<int, int> accelerationIndicesForDecrement_;
+    EncoderAccelerationTable accelerationTable_;
+    
+    static double GetDelta(int value)
+    {
+        double delta = (value & 0x3f) / 63.0;
+        
+        if (value & 0x40)
+            delta = -delta;
+        
+        return delta / 2.0;
+    }
 
 public:
     virtual ~AcceleratedEncoder_Midi_CSIMessageGenerator() {}
@@ -218,42 +255,21 @@ public:
                     decValues.push_back(strtol(strVal.c_str(), nullptr, 16));
             }
             
-            if(incValues.size() > 0)
-            {
-                if(incValues.size() == 1)
-                    accelerationIndicesForIncrement_[incValues[0]] = 0;
-                else
-                    for(int i = 0; i < incValues.size(); i++)
-                        accelerationIndicesForIncrement_[incValues[i]] = i;
-            }
+            // Decrements first, so a value listed in both keeps the increment mapping, as the old lookup order did
+            for(int i = 0; i < (int)decValues.size(); i++)
+                accelerationTable_.Set(decValues[i], i, GetDelta(decValues[i]));
             
-            if(decValues.size() > 0)
-            {
-                if(decValues.size() == 1)
-                    accelerationIndicesForDecrement_[decValues[0]] = 0;
-                else
-                    for(int i = 0; i < decValues.size(); i++)
-                        accelerationIndicesForDecrement_[decValues[i]] = i;
-            }
+            for(int i = 0; i < (int)incValues.size(); i++)
+                accelerationTable_.Set(incValues[i], i, GetDelta(incValues[i]));
         }
     }
     
     virtual void ProcessMidiMessage(const MIDI_event_ex_t* midiMessage) override
     {
-        int val = midiMessage->midi_message[2];
-
-        double delta = (midiMessage->midi_message[2] & 0x3f) / 63.0;
-        
-        if (midiMessage->midi_message[2] & 0x40)
-            delta = -delta;
-        
-        delta = delta / 2.0;
-
-        if(accelerationIndicesForIncrement_.count(val) > 0)
-            widget_->QueueRelativeAction(accelerationIndicesForIncrement_[val], delta);
+        const EncoderAccelerationTable::Entry &entry = accelerationTable_.Get(midiMessage->midi_message[2]);
         
-        else if(accelerationIndicesForDecrement_.count(val) > 0)
-            widget_->QueueRelativeAction(accelerationIndicesForDecrement_[val], delta);
+        if(entry.accelerationIndex >= 0)
+            widget_->QueueRelativeAction(entry.accelerationIndex, entry.delta);
     }
 };
 
@@ -262,8 +278,7 @@ class MFT_AcceleratedEncoder_Midi_CSIMessageGenerator : public Midi_CSIMessageGe
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
 private:
-    map<int, int> accelerationIndicesForIncrement_;
-    map<int, int> accelerationIndicesForDecrement_;
+    EncoderAccelerationTable accelerationTable_;
     
 public:
     virtual ~MFT_AcceleratedEncoder_Midi_CSIMessageGenerator() {}
@@ -271,40 +286,71 @@ public:
     {
         surface->AddCSIMessageGenerator(message->midi_message[0] * 0x10000 + message->midi_message[1] * 0x100, this);
     
-        accelerationIndicesForDecrement_[0x3f] = 0;
-        accelerationIndicesForDecrement_[0x3e] = 1;
-        accelerationIndicesForDecrement_[0x3d] = 2;
-        accelerationIndicesForDecrement_[0x3c] = 3;
-        accelerationIndicesForDecrement_[0x3b] = 4;
-        accelerationIndicesForDecrement_[0x3a] = 5;
-        accelerationIndicesForDecrement_[0x39] = 6;
-        accelerationIndicesForDecrement_[0x38] = 7;
-        accelerationIndicesForDecrement_[0x36] = 8;
-        accelerationIndicesForDecrement_[0x33] = 9;
-        accelerationIndicesForDecrement_[0x2f] = 10;
-
-        accelerationIndicesForIncrement_[0x41] = 0;
-        accelerationIndicesForIncrement_[0x42] = 1;
-        accelerationIndicesForIncrement_[0x43] = 2;
-        accelerationIndicesForIncrement_[0x44] = 3;
-        accelerationIndicesForIncrement_[0x45] = 4;
-        accelerationIndicesForIncrement_[0x46] = 5;
-        accelerationIndicesForIncrement_[0x47] = 6;
-        accelerationIndicesForIncrement_[0x48] = 7;
-        accelerationIndicesForIncrement_[0x4a] = 8;
-        accelerationIndicesForIncrement_[0x4d] = 9;
-        accelerationIndicesForIncrement_[0x51] = 10;
+        int decValues[] = { 0x3f, 0x3e, 0x3d, 0x3c, 0x3b, 0x3a, 0x39, 0x38, 0x36, 0x33, 0x2f };
+        int incValues[] = { 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x4a, 0x4d, 0x51 };
+        
+        for(int i = 0; i < (int)(sizeof(decValues) / sizeof(int)); i++)
+            accelerationTable_.Set(decValues[i], i, -0.001);
+        
+        for(int i = 0; i < (int)(sizeof(incValues) / sizeof(int)); i++)
+            accelerationTable_.Set(incValues[i], i, 0.001);
     }
     
     virtual void ProcessMidiMessage(const MIDI_event_ex_t* midiMessage) override
     {
-        int val = midiMessage->midi_message[2];
+        const EncoderAccelerationTable::Entry &entry = accelerationTable_.Get(midiMessage->midi_message[2]);
         
-        if(accelerationIndicesForIncrement_.count(val) > 0)
-            widget_->QueueRelativeAction(accelerationIndicesForIncrement_[val], 0.001);
+        if(entry.accelerationIndex >= 0)
+            widget_->QueueRelativeAction(entry.accelerationIndex, entry.delta);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TimeAcceleratedEncoder_Midi_CSIMessageGenerator : public Midi_CSIMessageGenerator
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // For surfaces that only ever send +/-1 -- acceleration comes from the time between ticks instead of the data byte
+    // Ticks further apart than SlowInterval get index 0, ticks closer than FastInterval get MaxIndex, linear in between
+    
+private:
+    static constexpr double SlowInterval = 120.0;  // ms
+    static constexpr double FastInterval = 10.0;   // ms
+    static const int MaxIndex = 10;
+    
+    double lastTickTimestamp_ = 0.0;
+    int lastAccelerationIndex_ = 0;
+    
+public:
+    virtual ~TimeAcceleratedEncoder_Midi_CSIMessageGenerator() {}
+    TimeAcceleratedEncoder_Midi_CSIMessageGenerator(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* message) : Midi_CSIMessageGenerator(widget)
+    {
+        surface->AddCSIMessageGenerator(message->midi_message[0] * 0x10000 + message->midi_message[1] * 0x100, this);
+    }
+    
+    virtual void ProcessMidiMessage(const MIDI_event_ex_t* midiMessage) override
+    {
+        double timestamp = widget_->GetSurface()->GetInputTimestamp();
+        double interval = timestamp - lastTickTimestamp_;
+        
+        // Polled input stamps a whole Run's worth of events with the same time, keep the rate from the first of them
+        if(interval > 0.0)
+        {
+            if(interval >= SlowInterval)
+                lastAccelerationIndex_ = 0;
+            else if(interval <= FastInterval)
+                lastAccelerationIndex_ = MaxIndex;
+            else
+                lastAccelerationIndex_ = int(MaxIndex * (SlowInterval - interval) / (SlowInterval - FastInterval));
+        }
+        
+        lastTickTimestamp_ = timestamp;
         
-        else if(accelerationIndicesForDecrement_.count(val) > 0)
-            widget_->QueueRelativeAction(accelerationIndicesForDecrement_[val], -0.001);
+        double delta = (midiMessage->midi_message[2] & 0x3f) / 126.0;
+        
+        if (midiMessage->midi_message[2] & 0x40)
+            delta = -delta;
+        
+        widget_->QueueRelativeAction(lastAccelerationIndex_, delta * (1 + lastAccelerationIndex_));
     }
 };
 
@@ -388,8 +434,13 @@ public:
     virtual ~TwoState_Midi_FeedbackProcessor() {}
     TwoState_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1, MIDI_event_ex_t* feedback2) : Midi_FeedbackProcessor(surface, widget, feedback1, feedback2) { }
     
+    virtual int Quantize(double value) override { return value == 0.0 ? 0 : 1; }
+    
     virtual void SetValue(double value) override
     {
+        if(GetIsShowingValue(value))
+            return;
+        
         if(value == 0.0)
         {
             if(midiFeedbackMessage2_)
@@ -428,6 +479,8 @@ public:
     virtual ~NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor() {}
     NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityColour; }
+    
     virtual void SetRGBValue(int r, int g, int b) override
     {
         if(r == lastR && g == lastG && b == lastB)
@@ -442,31 +495,27 @@ public:
         lastG = g;
         lastB = b;
         
-        struct
-        {
-            MIDI_event_ex_t evt;
-            char data[64];
-        } midiSysExData;
+        QueueRGBValue(r, g, b);
+    }
+    
+    virtual int GetColorSysExHeader(unsigned char* header) override
+    {
+        const unsigned char launchpadHeader[] = { 0xF0, 0x00, 0x20, 0x29, 0x02, 0x0d, 0x03 };
         
-        midiSysExData.evt.frame_offset = 0;
-        midiSysExData.evt.size = 0;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0xF0;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x00;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x20;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x29;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x02;;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x0d;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x03;
-        
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x03;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = midiFeedbackMessage1_->midi_message[1] ;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = r / 2; // only 127 bit max for this device
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = g / 2;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = b / 2;
+        memcpy(header, launchpadHeader, sizeof(launchpadHeader));
         
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0xF7;
+        return sizeof(launchpadHeader);
+    }
+    
+    virtual int GetColorSysExEntry(int r, int g, int b, unsigned char* entry) override
+    {
+        entry[0] = 0x03; // RGB
+        entry[1] = midiFeedbackMessage1_->midi_message[1];
+        entry[2] = r / 2; // only 127 bit max for this device
+        entry[3] = g / 2;
+        entry[4] = b / 2;
         
-        SendMidiMessage(&midiSysExData.evt);
+        return 5;
     }
 };
 
@@ -483,6 +532,8 @@ public:
     virtual ~FaderportRGB7Bit_Midi_FeedbackProcessor() {}
     FaderportRGB7Bit_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityColour; }
+    
     virtual void SetRGBValue(int r, int g, int b) override
     {
         if(r == lastR_ && g == lastG_ && b == lastB_)
@@ -497,6 +548,11 @@ public:
         lastG_ = g;
         lastB_ = b;
         
+        QueueRGBValue(r, g, b);
+    }
+    
+    virtual void SendRGBValue(int r, int g, int b) override
+    {
         SendMidiMessage(0x90, midiFeedbackMessage1_->midi_message[1], 0x7f);
         SendMidiMessage(0x91, midiFeedbackMessage1_->midi_message[1], r / 2);  // only 127 bit allowed in Midi byte 3
         SendMidiMessage(0x92, midiFeedbackMessage1_->midi_message[1], g / 2);
@@ -512,10 +568,20 @@ public:
     virtual ~Fader14Bit_Midi_FeedbackProcessor() {}
     Fader14Bit_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
+    virtual int Quantize(double value) override { return value * 16383.0; }
+    
     virtual void SetValue(double value) override
     {
-        int volint = value * 16383.0;
-        SendMidiMessage(midiFeedbackMessage1_->midi_message[0], volint&0x7f, (volint>>7)&0x7f);
+        if(widget_->GetShouldSuppressFeedback(value, 16383.0))
+            return;
+        
+        if(widget_->GetShouldResyncFeedback())
+            ForceValue(value);
+        else if( ! GetIsShowingValue(value))
+        {
+            int volint = value * 16383.0;
+            SendMidiMessage(midiFeedbackMessage1_->midi_message[0], volint&0x7f, (volint>>7)&0x7f);
+        }
     }
     
     virtual void ForceValue(double value) override
@@ -543,9 +609,17 @@ public:
     virtual ~Fader7Bit_Midi_FeedbackProcessor() {}
     Fader7Bit_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
+    virtual int Quantize(double value) override { return value * 127.0; }
+    
     virtual void SetValue(double value) override
     {
-        SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1], value * 127.0);
+        if(widget_->GetShouldSuppressFeedback(value, 127.0))
+            return;
+        
+        if(widget_->GetShouldResyncFeedback())
+            ForceValue(value);
+        else if( ! GetIsShowingValue(value))
+            SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1], value * 127.0);
     }
     
     virtual void ForceValue(double value) override
@@ -584,7 +658,10 @@ public:
 
     virtual void SetValue(int displayMode, double value) override
     {
-        SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1] + 0x20, GetMidiValue(displayMode, value));
+        int midiValue = GetMidiValue(displayMode, value); // the ring position and display mode
+        
+        if( ! GetIsShowingStep(midiValue))
+            SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1] + 0x20, midiValue);
     }
 
     virtual void ForceValue(int displayMode, double value) override
@@ -613,9 +690,16 @@ public:
     virtual ~VUMeter_Midi_FeedbackProcessor() {}
     VUMeter_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityMeter; }
+    
+    virtual int Quantize(double value) override { return GetMidiValue(value); }
+    
     virtual void SetValue(double value) override
     {
-        SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1], GetMidiValue(value));
+        int midiValue = Quantize(value);
+        
+        if( ! GetIsShowingStep(midiValue))
+            SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1], midiValue);
     }
 
     virtual void ForceValue(double value) override
@@ -650,9 +734,16 @@ public:
     virtual ~GainReductionMeter_Midi_FeedbackProcessor() {}
     GainReductionMeter_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityMeter; }
+    
+    virtual int Quantize(double value) override { return fabs(1.0 - value) * 127.0; }
+    
     virtual void SetValue(double value) override
     {
-        SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1], fabs(1.0 - value) * 127.0);
+        int midiValue = Quantize(value);
+        
+        if( ! GetIsShowingStep(midiValue))
+            SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1], midiValue);
     }
 
     virtual void ForceValue(double value) override
@@ -674,6 +765,8 @@ public:
     virtual ~QConProXMasterVUMeter_Midi_FeedbackProcessor() {}
     QConProXMasterVUMeter_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int param) : Midi_FeedbackProcessor(surface, widget), param_(param) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityMeter; }
+    
     virtual void SetValue(double value) override
     {
         //Master Channel:
@@ -688,7 +781,8 @@ public:
         if(midiValue > 0x0d)
             midiValue = 0x0d;
         
-        SendMidiMessage(0xd1, (param_ << 4) | midiValue, 0);
+        if( ! GetIsShowingStep(midiValue))
+            SendMidiMessage(0xd1, (param_ << 4) | midiValue, 0);
     }
 
     virtual void ForceValue(double value) override
@@ -723,9 +817,16 @@ public:
     virtual ~MCUVUMeter_Midi_FeedbackProcessor() {}
     MCUVUMeter_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int displayType, int channelNumber) : Midi_FeedbackProcessor(surface, widget), displayType_(displayType), channelNumber_(channelNumber) {}
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityMeter; }
+    
+    virtual int Quantize(double value) override { return GetMidiValue(value); }
+    
     virtual void SetValue(double value) override
     {
-        SendMidiMessage(0xd0, (channelNumber_ << 4) | GetMidiValue(value), 0);
+        int midiValue = Quantize(value);
+        
+        if( ! GetIsShowingStep(midiValue))
+            SendMidiMessage(0xd0, (channelNumber_ << 4) | midiValue, 0);
     }
 
     virtual void ForceValue(double value) override
@@ -759,26 +860,29 @@ public:
     virtual ~MCUDisplay_Midi_FeedbackProcessor() {}
     MCUDisplay_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int displayUpperLower, int displayType, int displayRow, int channel) : Midi_FeedbackProcessor(surface, widget), offset_(displayUpperLower * 56), displayType_(displayType), displayRow_(displayRow), channel_(channel) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityText; }
+    
     virtual void ClearCache() override
     {
         lastStringSent_ = " ";
     }
     
-    virtual void SetValue(string displayText) override
+    virtual void SetValue(const string &displayText) override
     {
         if(displayText != lastStringSent_) // changes since last send
             ForceValue(displayText);
     }
 
-    virtual void ForceValue(string displayText) override
+    virtual void ForceValue(const string &displayText) override
     {
         lastStringSent_ = displayText;
         
+        const char* text = displayText.c_str();
+        
         if(displayText == "" || displayText == "-150.00")
-            displayText = "       ";
+            text = "       ";
 
         int pad = 7;
-        const char* text = displayText.c_str();
         
         struct
         {
@@ -1098,6 +1202,8 @@ public:
     virtual ~SCE24_Text_Midi_FeedbackProcessor() {}
     SCE24_Text_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int cellNumber, int itemNumber) : SCE24_Midi_FeedbackProcessor(surface, widget, cellNumber, itemNumber) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityText; }
+    
     virtual int GetMaxCharacters() override
     {
         return maxChars.GetMaxCharacters(displayType_, itemNumber_);
@@ -1108,13 +1214,13 @@ public:
         lastStringValue_ = " ";
     }
     
-    virtual void SetValue(string displayText) override
+    virtual void SetValue(const string &displayText) override
     {
         if(displayText != lastStringValue_) // changes since last send
             ForceValue(displayText);
     }
 
-    virtual void ForceValue(string value) override
+    virtual void ForceValue(const string &value) override
     {
         lastStringValue_ = value;
         text_ = value;
@@ -1198,14 +1304,17 @@ public:
        
     virtual void ClearCache() override
     {
-        lastDoubleValue_ = 0.0;
+        lastDoubleValue_ = -1.0;
+        lastStep_ = -1;
     }
     
+    virtual int Quantize(double value) override { return int(value * 100.00); }
+    
     virtual void SetValue(double value) override
     {
-        if(int(value * 100.00) != (int)lastDoubleValue_) // changes since last send
+        if( ! GetIsShowingValue(value)) // changes since last send
         {
-            lastDoubleValue_ = int(value * 100.00);
+            lastDoubleValue_ = lastStep_;
             SendMidiMessage(0xB0 | itemNumber_, cellNumber_, (int)lastDoubleValue_);
         }
     }
@@ -1252,14 +1361,17 @@ public:
        
     virtual void ClearCache() override
     {
-        lastDoubleValue_ = 0.0;
+        lastDoubleValue_ = -1.0;
+        lastStep_ = -1;
     }
     
+    virtual int Quantize(double value) override { return int(value * 100.00); }
+    
     virtual void SetValue(double value) override
     {
-        if(int(value * 100.00) != (int)lastDoubleValue_) // changes since last send
+        if( ! GetIsShowingValue(value)) // changes since last send
         {
-            lastDoubleValue_ = int(value * 100.00);
+            lastDoubleValue_ = lastStep_;
             SendMidiMessage(0xB0, cellNumber_, (int)lastDoubleValue_);
         }
     }
@@ -1305,6 +1417,8 @@ public:
     virtual ~SCE24_OLEDButton_Midi_FeedbackProcessor() {}
     SCE24_OLEDButton_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int cellNumber, int itemNumber) : SCE24_Midi_FeedbackProcessor(surface, widget, cellNumber, itemNumber) {}
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityText; }
+    
     virtual int GetMaxCharacters() override
     {
         return maxChars.GetMaxCharacters(displayType_);
@@ -1312,8 +1426,8 @@ public:
     
     virtual void ClearCache() override
     {
-        lastDoubleValue_ = 0;
-        lastStringValue_ = "";
+        lastDoubleValue_ = -1.0;
+        lastStringValue_ = " ";
     }
     
     virtual void ForceClear() override
@@ -1333,13 +1447,13 @@ public:
         SetCurrentColor(value); // This will cause a Force()
     }
     
-    virtual void SetValue(string value) override
+    virtual void SetValue(const string &value) override
     {
         if(value != lastStringValue_) // changes since last send
             ForceValue(value);
     }
     
-    void ForceValue(string value) override
+    void ForceValue(const string &value) override
     {
         lastStringValue_ = value;
         text_ = value;
@@ -1415,7 +1529,7 @@ public:
     
     virtual void ClearCache() override
     {
-        lastDoubleValue_ = 0.0;
+        lastDoubleValue_ = -1.0;
     }
     
     virtual void SetValue(double value) override
@@ -1470,9 +1584,11 @@ public:
     virtual ~SCE24_Background_Midi_FeedbackProcessor() {}
     SCE24_Background_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int cellNumber) : SCE24_Midi_FeedbackProcessor(surface, widget, cellNumber) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityColour; }
+    
     virtual void ClearCache() override
     {
-        lastDoubleValue_ = 0.0;
+        lastDoubleValue_ = -1.0;
     }
     
     virtual void SetValue(double value) override
@@ -1533,25 +1649,27 @@ public:
     virtual ~FPDisplay_Midi_FeedbackProcessor() {}
     FPDisplay_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int displayType, int channel, int displayRow) : Midi_FeedbackProcessor(surface, widget), displayType_(displayType), channel_(channel), displayRow_(displayRow) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityText; }
+    
     virtual void ClearCache() override
     {
         lastStringSent_ = " ";
     }
     
-    virtual void SetValue(string displayText) override
+    virtual void SetValue(const string &displayText) override
     {
         if(displayText != lastStringSent_) // changes since last send
             ForceValue(displayText);
     }
     
-    virtual void ForceValue(string displayText) override
+    virtual void ForceValue(const string &displayText) override
     {
         lastStringSent_ = displayText;
 
-        if(displayText == "")
-            displayText = "                            ";
-        
         const char* text = displayText.c_str();
+        
+        if(displayText == "")
+            text = "                            ";
     
         struct
         {
@@ -1608,26 +1726,29 @@ public:
     virtual ~QConLiteDisplay_Midi_FeedbackProcessor() {}
     QConLiteDisplay_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, int displayUpperLower, int displayType, int displayRow, int channel) : Midi_FeedbackProcessor(surface, widget), offset_(displayUpperLower * 28), displayType_(displayType), displayRow_(displayRow), channel_(channel) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityText; }
+    
     virtual void ClearCache() override
     {
         lastStringSent_ = " ";
     }
     
-    virtual void SetValue(string displayText) override
+    virtual void SetValue(const string &displayText) override
     {
         if(displayText != lastStringSent_) // changes since last send
             ForceValue(displayText);
     }
     
-    virtual void ForceValue(string displayText) override
+    virtual void ForceValue(const string &displayText) override
     {
         lastStringSent_ = displayText;
         
+        const char* text = displayText.c_str();
+        
         if(displayText == "")
-            displayText = "       ";
+            text = "       ";
         
         int pad = 7;
-        const char* text = displayText.c_str();
         
         struct
         {
@@ -1678,6 +1799,9 @@ class MCU_TimeDisplay_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
 public:
     MCU_TimeDisplay_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget) : Midi_FeedbackProcessor(surface, widget) {}
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityText; }
+    virtual bool GetIsReadingDAW() override { return true; } // the play position and time mode
+    
     virtual void SetValue(double value) override
     {
         
@@ -2028,6 +2152,8 @@ public:
     virtual ~MFT_RGB_Midi_FeedbackProcessor() {}
     MFT_RGB_Midi_FeedbackProcessor(Midi_ControlSurface* surface, Widget* widget, MIDI_event_ex_t* feedback1) : Midi_FeedbackProcessor(surface, widget, feedback1) { }
     
+    virtual int GetOutputPriority() override { return MidiOutputPriorityColour; }
+    
     virtual void ForceRGBValue(int r, int g, int b) override
     {
         lastR = r;
@@ -2037,7 +2163,12 @@ public:
         if((r == 177 || r == 181) && g == 31) // this sets the different MFT modes
             SendMidiMessage(r, g, b);
         else
-            SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1], GetColorIntFromRGB(r, g, b));
+            QueueRGBValue(r, g, b);
+    }
+    
+    virtual void SendRGBValue(int r, int g, int b) override
+    {
+        SendMidiMessage(midiFeedbackMessage1_->midi_message[0], midiFeedbackMessage1_->midi_message[1], GetColorIntFromRGB(r, g, b));
     }
 
     virtual void SetRGBValue(int r, int g, int b) override
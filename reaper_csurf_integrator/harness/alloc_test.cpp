@@ -0,0 +1,118 @@
+//
+//  alloc_test.cpp
+//  reaper_csurf_integrator
+//
+//  Fails when a steady frame allocates, counting every operator new once the surface has settled
+//
+
+#include "daw_stubs.h"
+#include <new>
+
+const int NumWarmupFrames = 50;
+const int NumCountedFrames = 200;
+
+static atomic<bool> isCounting_ { false };
+static atomic<long long> numAllocations_ { 0 };
+
+void* operator new(size_t size)
+{
+    if(isCounting_)
+        numAllocations_++;
+
+    if(void* p = malloc(size > 0 ? size : 1))
+        return p;
+
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+// Out of line, so gcc doesn't see malloc's pointer reach free through operator delete and call it a mismatch
+__attribute__((noinline)) static void Release(void* p) { free(p); }
+
+void operator delete(void* p) noexcept { Release(p); }
+void operator delete[](void* p) noexcept { Release(p); }
+void operator delete(void* p, size_t) noexcept { Release(p); }
+void operator delete[](void* p, size_t) noexcept { Release(p); }
+
+static string resourcePath_ = "/tmp/csi_alloc_test";
+
+static void RunFrame()
+{
+    AdvanceFakeDAWFrame();
+    TheManager->Run();
+}
+
+static void SetFaderTouches(Midi_ControlSurface* surface, int numChannels, bool isTouched)
+{
+    for(int i = 0; i < numChannels; i++)
+        QueueFakeMidiInput(MIDI_event_ex_t(0x90 | (i % 16), 0x18 + i / 16, isTouched ? 0x7f : 0x00));
+
+    surface->HandleExternalInput();
+}
+
+// Returns the number of allocations over the counted frames, after the warmup ones have filled every cache
+static long long CountFrameAllocations()
+{
+    for(int i = 0; i < NumWarmupFrames; i++)
+        RunFrame();
+
+    numAllocations_ = 0;
+    isCounting_ = true;
+
+    for(int i = 0; i < NumCountedFrames; i++)
+        RunFrame();
+
+    isCounting_ = false;
+
+    return numAllocations_;
+}
+
+static bool Check(const char* name, int numChannels, long long numAllocations)
+{
+    printf("%-24s %2d channels  %d feedback workers  %lld allocations in %d frames\n", name, numChannels, GetNumFeedbackWorkers(), numAllocations, NumCountedFrames);
+
+    return numAllocations == 0;
+}
+
+int main(int argc, const char* argv[])
+{
+    bool isPassing = true;
+
+    for(int numChannels : { 8, 24 })
+    for(const char* numFeedbackWorkers : { "0", "2" })
+    {
+        InstallFakeDAW(resourcePath_, numChannels * 2);
+        SetFakeCSIOption("FeedbackWorkers", numFeedbackWorkers);
+        WriteSyntheticFixtures(resourcePath_, numChannels);
+        StartManager();
+
+        Midi_ControlSurface* surface = GetSyntheticSurface();
+
+        if(surface == nullptr || ! surface->GetIsOnline())
+        {
+            fprintf(stderr, "the %d channel surface did not come online\n", numChannels);
+            return 1;
+        }
+
+        isPassing &= Check("Idle", numChannels, CountFrameAllocations());
+
+        TheManager->GetCurrentPage()->SetShift(true);
+        isPassing &= Check("Shift", numChannels, CountFrameAllocations());
+        TheManager->GetCurrentPage()->SetShift(false);
+        AdvanceFakeDAWClock(200.0); // past the quick release latch
+
+        SetFaderTouches(surface, numChannels, true);
+        isPassing &= Check("FadersTouched", numChannels, CountFrameAllocations());
+        SetFaderTouches(surface, numChannels, false);
+
+        StopManager();
+    }
+
+    printf(isPassing ? "PASS\n" : "FAIL, steady frames allocate\n");
+
+    return isPassing ? 0 : 1;
+}
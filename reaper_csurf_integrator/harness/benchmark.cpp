@@ -0,0 +1,186 @@
+//
+//  benchmark.cpp
+//  reaper_csurf_integrator
+//
+//  The hot paths against 8, 24 and 64 channel synthetic surfaces, results as JSON on stdout or in the file named on the command line
+//
+
+#include "daw_stubs.h"
+
+const double MinMilliseconds = 200.0;
+
+static string resourcePath_ = "/tmp/csi_benchmark";
+
+// MCU style traffic, every fader and encoder moves and every mute is pressed and released
+static void AddInputBurst(vector<MIDI_event_ex_t> &events, int numChannels)
+{
+    for(int i = 0; i < numChannels; i++)
+    {
+        int midiChannel = i % 16;
+        int block = i / 16;
+        
+        events.push_back(MIDI_event_ex_t(0xb0 | midiChannel, block, 0x40 + i % 16));
+        events.push_back(MIDI_event_ex_t(0xb0 | midiChannel, 0x10 + block, 0x41));
+        events.push_back(MIDI_event_ex_t(0x90 | midiChannel, block, 0x7f));
+        events.push_back(MIDI_event_ex_t(0x90 | midiChannel, block, 0x00));
+    }
+}
+
+static void SetFaderTouches(Midi_ControlSurface* surface, int numChannels, bool isTouched)
+{
+    for(int i = 0; i < numChannels; i++)
+    {
+        MIDI_event_ex_t event(0x90 | (i % 16), 0x18 + i / 16, isTouched ? 0x7f : 0x00);
+        QueueFakeMidiInput(event);
+    }
+    
+    surface->HandleExternalInput();
+
+    surface->RequestUpdate(); // queued touches are applied here
+}
+
+static void SetShift(bool value)
+{
+    TheManager->GetCurrentPage()->SetShift(value);
+    AdvanceFakeDAWClock(200.0); // past the quick release latch
+}
+
+static void SetOption(bool value)
+{
+    TheManager->GetCurrentPage()->SetOption(value);
+    AdvanceFakeDAWClock(200.0);
+}
+
+static void RunToCompletion(BenchmarkRunner &runner)
+{
+    while( ! runner.GetIsDone())
+        runner.Run(MinMilliseconds);
+}
+
+static void RunSurfaceBenchmarks(BenchmarkRunner &runner, int numChannels)
+{
+    InstallFakeDAW(resourcePath_, numChannels * 2);
+    WriteSyntheticFixtures(resourcePath_, numChannels);
+    StartManager();
+    
+    Midi_ControlSurface* surface = GetSyntheticSurface();
+    
+    if(surface == nullptr || ! surface->GetIsOnline())
+    {
+        fprintf(stderr, "the %d channel surface did not come online\n", numChannels);
+        exit(1);
+    }
+    
+    runner.SetGroup(to_string(numChannels) + " channels");
+    
+    // The ones the DAW action runs too
+    TheManager->AddBenchmarks(runner);
+    RunToCompletion(runner);
+    
+    // Dispatch all the way to the actions, against the fake project, plus the frame that runs them
+    vector<MIDI_event_ex_t> events;
+    AddInputBurst(events, numChannels);
+    
+    runner.AddBenchmark("ProcessMidiMessage", events.size(), [&]()
+    {
+        for(auto &event : events)
+            QueueFakeMidiInput(event);
+        
+        surface->HandleExternalInput();
+        surface->RequestUpdate();
+    });
+    
+    RunToCompletion(runner);
+    
+    // Zone::GetActionContexts with no modifier, each single modifier, and every fader touched
+    vector<pair<Zone*, Widget*>> lookups;
+    
+    for(auto zone : surface->GetZones())
+        for(auto widget : zone->GetWidgets())
+            lookups.push_back(make_pair(zone, widget));
+    
+    auto getActionContexts = [&]()
+    {
+        static size_t numContexts = 0;
+        
+        for(auto &[zone, widget] : lookups)
+            numContexts += zone->GetActionContexts(widget).size();
+    };
+    
+    runner.AddBenchmark("GetActionContexts/Unmodified", lookups.size(), getActionContexts);
+    RunToCompletion(runner);
+    
+    SetShift(true);
+    runner.AddBenchmark("GetActionContexts/Shift", lookups.size(), getActionContexts);
+    RunToCompletion(runner);
+    SetShift(false);
+    
+    SetOption(true);
+    runner.AddBenchmark("GetActionContexts/Option", lookups.size(), getActionContexts);
+    RunToCompletion(runner);
+    SetOption(false);
+    
+    SetFaderTouches(surface, numChannels, true);
+    runner.AddBenchmark("GetActionContexts/Touched", lookups.size(), getActionContexts);
+    RunToCompletion(runner);
+    SetFaderTouches(surface, numChannels, false);
+    
+    // A steady frame, the meters move and everything else is unchanged
+    runner.AddBenchmark("RequestUpdate", numChannels, [&]()
+    {
+        AdvanceFakeDAWFrame();
+        surface->RequestUpdate();
+    });
+    
+    RunToCompletion(runner);
+    
+    // Parsing from the cached tokens, so no file I/O
+    string zoneFilePath = resourcePath_ + "/CSI/Zones/Synthetic/Channel.zon";
+    
+    runner.AddBenchmark("ProcessZoneFile/Channel.zon", 1, [&]()
+    {
+        surface->ReloadZoneFile(zoneFilePath);
+    });
+    
+    RunToCompletion(runner);
+    
+    // MCU display sysex, every upper display gets new text
+    vector<Widget*> displays;
+    
+    for(int i = 0; i < numChannels; i++)
+        displays.push_back(surface->GetWidgetByName("DisplayUpper" + to_string(i + 1)));
+    
+    int frame = 0;
+    
+    runner.AddBenchmark("MCUDisplay", numChannels, [&]()
+    {
+        const string text = (frame++ & 1) ? "Vox 1" : "Gtr 2";
+        
+        for(auto display : displays)
+            display->UpdateValue(text);
+    });
+    
+    RunToCompletion(runner);
+    
+    StopManager();
+}
+
+int main(int argc, const char* argv[])
+{
+    BenchmarkRunner runner(MinMilliseconds);
+    
+    for(int numChannels : { 8, 24, 64 })
+        RunSurfaceBenchmarks(runner, numChannels);
+    
+    string json = runner.GetJSON();
+    
+    if(argc > 1)
+    {
+        ofstream jsonFile(argv[1], ios::trunc);
+        jsonFile << json;
+    }
+    else
+        fputs(json.c_str(), stdout);
+    
+    return 0;
+}
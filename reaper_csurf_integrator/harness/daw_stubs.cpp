@@ -0,0 +1,424 @@
+//
+//  daw_stubs.cpp
+//  reaper_csurf_integrator
+//
+
+#define REAPERAPI_IMPLEMENT
+#define REAPERAPI_DECL
+
+#include "daw_stubs.h"
+#include "../reaper_plugin_functions.h"
+
+Manager* TheManager = nullptr;
+HWND g_hwnd = nullptr;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct FakeTrack
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    char name[64];
+    double volume = 1.0;
+    double pan = 0.0;
+    double width = 1.0;
+    bool isMuted = false;
+    double peak = 0.0;
+};
+
+static string resourcePath_;
+static string iniFilePath_;
+static vector<FakeTrack*> tracks_;
+static FakeTrack masterTrack_;
+static int frame_ = 0;
+static double clockOffset_ = 0.0;
+static vector<MIDI_event_t> pendingInput_; // handed to the next input read, capacity is kept so a steady stream doesn't allocate
+static map<string, string> csiOptions_;
+static FakeDAWStats stats_;
+static char projectConfig_[64]; // every projectconfig variable reads as zero
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class FakeMidiOutput : public midi_Output
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    virtual void SendMsg(MIDI_event_t *msg, int frame_offset) override
+    {
+        stats_.numMidiMessagesSent++;
+        stats_.numMidiBytesSent += msg->size;
+    }
+
+    virtual void Send(unsigned char status, unsigned char d1, unsigned char d2, int frame_offset) override
+    {
+        stats_.numMidiMessagesSent++;
+        stats_.numMidiBytesSent += 3;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class FakeMidiEventList : public MIDI_eventlist
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    vector<MIDI_event_t> events_;
+
+    virtual void AddItem(MIDI_event_t *evt) override { events_.push_back(*evt); }
+    virtual MIDI_event_t *EnumItems(int *bpos) override { return *bpos < (int)events_.size() ? &events_[(*bpos)++] : nullptr; }
+    virtual void DeleteItem(int bpos) override {}
+    virtual int GetSize() override { return (int)events_.size(); }
+    virtual void Empty() override { events_.clear(); }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class FakeMidiInput : public midi_Input
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    FakeMidiEventList events_;
+
+public:
+    virtual void start() override {}
+    virtual void stop() override {}
+    virtual void SwapBufs(unsigned int timestamp) override
+    {
+        events_.events_.swap(pendingInput_);
+        pendingInput_.clear();
+    }
+    virtual MIDI_eventlist *GetReadBuf() override { return &events_; }
+};
+
+static FakeTrack* ToFakeTrack(MediaTrack* track)
+{
+    return (FakeTrack*)track;
+}
+
+static MediaTrack* ToMediaTrack(FakeTrack* track)
+{
+    return (MediaTrack*)track;
+}
+
+// Anything not faked below answers zero or null
+static int ReturnZero() { return 0; }
+static void* GetFakeAPI(const char* name) { return (void*)&ReturnZero; }
+
+static const char* FakeGetResourcePath() { return resourcePath_.c_str(); }
+static const char* FakeGetIniFile() { return iniFilePath_.c_str(); }
+static void FakeShowConsoleMsg(const char* msg) { fputs(msg, stderr); }
+
+static int FakeCSurfNumTracks(bool mcpView) { return (int)tracks_.size(); }
+
+static MediaTrack* FakeCSurfTrackFromID(int idx, bool mcpView)
+{
+    if(idx == 0)
+        return ToMediaTrack(&masterTrack_);
+    else if(idx > 0 && idx <= (int)tracks_.size())
+        return ToMediaTrack(tracks_[idx - 1]);
+    else
+        return nullptr;
+}
+
+static int FakeCSurfTrackToID(MediaTrack* track, bool mcpView)
+{
+    for(int i = 0; i < (int)tracks_.size(); i++)
+        if(ToMediaTrack(tracks_[i]) == track)
+            return i + 1;
+
+    return 0;
+}
+
+static MediaTrack* FakeGetTrack(ReaProject* proj, int idx) { return idx >= 0 && idx < (int)tracks_.size() ? ToMediaTrack(tracks_[idx]) : nullptr; }
+static MediaTrack* FakeGetMasterTrack(ReaProject* proj) { return ToMediaTrack(&masterTrack_); }
+static bool FakeIsTrackVisible(MediaTrack* track, bool mixer) { return true; }
+static bool FakeValidatePtr(void* pointer, const char* ctypename) { return true; }
+
+static double FakeGetMediaTrackInfo_Value(MediaTrack* track, const char* parmname)
+{
+    if( ! track)
+        return 0.0;
+    else if( ! strcmp(parmname, "D_VOL"))
+        return ToFakeTrack(track)->volume;
+    else if( ! strcmp(parmname, "D_PAN"))
+        return ToFakeTrack(track)->pan;
+    else if( ! strcmp(parmname, "D_WIDTH"))
+        return ToFakeTrack(track)->width;
+    else if( ! strcmp(parmname, "B_MUTE"))
+        return ToFakeTrack(track)->isMuted;
+    else
+        return 0.0;
+}
+
+static void* FakeGetSetMediaTrackInfo(MediaTrack* track, const char* parmname, void* setNewValue)
+{
+    static char zero[16];
+
+    if(track && ! strcmp(parmname, "P_NAME"))
+        return ToFakeTrack(track)->name;
+
+    memset(zero, 0, sizeof(zero));
+    return zero;
+}
+
+static bool FakeGetTrackName(MediaTrack* track, char* bufOut, int bufOut_sz)
+{
+    snprintf(bufOut, bufOut_sz, "%s", track ? ToFakeTrack(track)->name : "");
+    return true;
+}
+
+static bool FakeGetTrackUIVolPan(MediaTrack* track, double* volumeOut, double* panOut)
+{
+    *volumeOut = ToFakeTrack(track)->volume;
+    *panOut = ToFakeTrack(track)->pan;
+    return true;
+}
+
+static bool FakeGetTrackUIPan(MediaTrack* track, double* pan1Out, double* pan2Out, int* panmodeOut)
+{
+    *pan1Out = ToFakeTrack(track)->pan;
+    *pan2Out = ToFakeTrack(track)->width;
+    *panmodeOut = 3;
+    return true;
+}
+
+static bool FakeGetTrackUIMute(MediaTrack* track, bool* muteOut)
+{
+    *muteOut = ToFakeTrack(track)->isMuted;
+    return true;
+}
+
+static double FakeTrack_GetPeakInfo(MediaTrack* track, int channel) { return track ? ToFakeTrack(track)->peak : 0.0; }
+
+static double FakeSLIDER2DB(double y) { return y; }
+static double FakeDB2SLIDER(double x) { return x; }
+static double FakeGetCursorPosition() { return 0.0; }
+static double FakeGetPlayPosition() { return 0.0; }
+static double FakeTimeMap2_timeToBeats(ReaProject* proj, double tpos, int* measuresOutOptional, int* cmlOutOptional, double* fullbeatsOutOptional, int* cdenomOutOptional) { return 0.0; }
+static double FakeGetTrackSendInfo_Value(MediaTrack* tr, int category, int sendidx, const char* parmname) { return 0.0; }
+static double FakeTrackFX_GetParam(MediaTrack* track, int fx, int param, double* minvalOut, double* maxvalOut) { return 0.0; }
+
+static void FakeFormat_timestr_pos(double tpos, char* buf, int buf_sz, int modeoverride)
+{
+    snprintf(buf, buf_sz, "0.0.00");
+}
+
+static int FakeGetProjExtState(ReaProject* proj, const char* extname, const char* key, char* valOutNeedBig, int valOutNeedBig_sz) { return 0; }
+
+static void* FakeProjectconfig_var_addr(ReaProject* proj, int idx) { return projectConfig_; }
+static int FakeProjectconfig_var_getoffs(const char* name, int* szOut) { return 0; }
+
+static midi_Input* FakeCreateMIDIInput(int dev) { return new FakeMidiInput(); }
+static midi_Output* FakeCreateMIDIOutput(int dev, bool streamMode, int* msoffset100) { return new FakeMidiOutput(); }
+
+static DWORD FakeGetPrivateProfileString(const char *appname, const char *keyname, const char *def, char *ret, int retsize, const char *fn)
+{
+    snprintf(ret, retsize, "%s", csiOptions_.count(keyname) > 0 ? csiOptions_[keyname].c_str() : def);
+    return (DWORD)strlen(ret);
+}
+
+static DWORD FakeGetTickCount() { return (DWORD)(DAW::GetPreciseNumberOfMilliseconds() + clockOffset_); }
+static LRESULT FakeSendMessage(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) { return 0; }
+
+void InstallFakeDAW(const string &resourcePath, int numTracks)
+{
+    resourcePath_ = resourcePath;
+    iniFilePath_ = resourcePath + "/reaper.ini";
+
+    REAPERAPI_LoadAPI(GetFakeAPI);
+
+    GetResourcePath = FakeGetResourcePath;
+    get_ini_file = FakeGetIniFile;
+    ShowConsoleMsg = FakeShowConsoleMsg;
+    CSurf_NumTracks = FakeCSurfNumTracks;
+    CSurf_TrackFromID = FakeCSurfTrackFromID;
+    CSurf_TrackToID = FakeCSurfTrackToID;
+    GetTrack = FakeGetTrack;
+    GetMasterTrack = FakeGetMasterTrack;
+    IsTrackVisible = FakeIsTrackVisible;
+    ValidatePtr = FakeValidatePtr;
+    GetMediaTrackInfo_Value = FakeGetMediaTrackInfo_Value;
+    GetSetMediaTrackInfo = FakeGetSetMediaTrackInfo;
+    GetTrackName = FakeGetTrackName;
+    GetTrackUIVolPan = FakeGetTrackUIVolPan;
+    GetTrackUIPan = FakeGetTrackUIPan;
+    GetTrackUIMute = FakeGetTrackUIMute;
+    Track_GetPeakInfo = FakeTrack_GetPeakInfo;
+    SLIDER2DB = FakeSLIDER2DB;
+    DB2SLIDER = FakeDB2SLIDER;
+    GetCursorPosition = FakeGetCursorPosition;
+    GetPlayPosition = FakeGetPlayPosition;
+    TimeMap2_timeToBeats = FakeTimeMap2_timeToBeats;
+    GetTrackSendInfo_Value = FakeGetTrackSendInfo_Value;
+    TrackFX_GetParam = FakeTrackFX_GetParam;
+    format_timestr_pos = FakeFormat_timestr_pos;
+    GetProjExtState = FakeGetProjExtState;
+    projectconfig_var_addr = FakeProjectconfig_var_addr;
+    projectconfig_var_getoffs = FakeProjectconfig_var_getoffs;
+    CreateMIDIInput = FakeCreateMIDIInput;
+    CreateMIDIOutput = FakeCreateMIDIOutput;
+
+    GetPrivateProfileString = FakeGetPrivateProfileString;
+    GetTickCount = FakeGetTickCount;
+    SendMessage = FakeSendMessage;
+
+    for(auto track : tracks_)
+        delete track;
+
+    tracks_.clear();
+
+    for(int i = 0; i < numTracks; i++)
+    {
+        FakeTrack* track = new FakeTrack();
+        snprintf(track->name, sizeof(track->name), "Track %d", i + 1);
+        track->volume = 0.1 + 0.8 * i / numTracks;
+        tracks_.push_back(track);
+    }
+
+    snprintf(masterTrack_.name, sizeof(masterTrack_.name), "MASTER");
+}
+
+void SetFakeCSIOption(const string &key, const string &value)
+{
+    csiOptions_[key] = value;
+}
+
+void AdvanceFakeDAWFrame()
+{
+    frame_++;
+
+    for(int i = 0; i < (int)tracks_.size(); i++)
+        tracks_[i]->peak = ((frame_ + i * 3) % 24) / 24.0;
+}
+
+void AdvanceFakeDAWClock(double milliseconds)
+{
+    clockOffset_ += milliseconds;
+}
+
+void QueueFakeMidiInput(const MIDI_event_ex_t &event)
+{
+    MIDI_event_t midiEvent;
+    midiEvent.frame_offset = 0;
+    midiEvent.size = event.size;
+    memcpy(midiEvent.midi_message, event.midi_message, 4);
+    pendingInput_.push_back(midiEvent);
+}
+
+FakeDAWStats &GetFakeDAWStats()
+{
+    return stats_;
+}
+
+static void WriteFile(const string &filePath, const string &contents)
+{
+    ofstream file(filePath, ios::trunc);
+    file << contents;
+}
+
+void WriteSyntheticFixtures(const string &resourcePath, int numChannels)
+{
+    string csiFolder = resourcePath + "/CSI";
+
+    for(auto folder : { resourcePath, csiFolder, csiFolder + "/Surfaces", csiFolder + "/Surfaces/Midi", csiFolder + "/Zones", csiFolder + "/Zones/Synthetic" })
+        mkdir(folder.c_str(), 0755);
+
+    WriteFile(csiFolder + "/CSI.ini",
+              "Version 2.0\n"
+              "Page \"Home\" FollowMCP NoSynchPages UseScrollLink\n"
+              "MidiSurface \"Synthetic\" 0 0 \"Synthetic.mst\" \"Synthetic\" " + to_string(numChannels) + " 8 8 0\n");
+
+    // MCU like channel strips, each channel on its own MIDI channel and note block so every message maps to one widget
+    char line[256];
+    string widgets;
+
+    for(int i = 0; i < numChannels; i++)
+    {
+        int midiChannel = i % 16;
+        int block = i / 16;
+
+        snprintf(line, sizeof(line),
+                 "Widget Fader%d\n\tFader7Bit b%x %02x 7f\n\tFB_Fader7Bit b%x %02x 7f\n\tTouch 9%x %02x 7f 9%x %02x 00\nWidgetEnd\n"
+                 "Widget Rotary%d\n\tEncoder b%x %02x 7f\n\tFB_Encoder b%x %02x 7f\nWidgetEnd\n",
+                 i + 1, midiChannel, block, midiChannel, block, midiChannel, 0x18 + block, midiChannel, 0x18 + block,
+                 i + 1, midiChannel, 0x10 + block, midiChannel, 0x30 + block);
+        widgets += line;
+
+        snprintf(line, sizeof(line),
+                 "Widget Mute%d\n\tPress 9%x %02x 7f 9%x %02x 00\n\tFB_TwoState 9%x %02x 7f 9%x %02x 00\nWidgetEnd\n"
+                 "Widget Select%d\n\tPress 9%x %02x 7f 9%x %02x 00\n\tFB_TwoState 9%x %02x 7f 9%x %02x 00\nWidgetEnd\n",
+                 i + 1, midiChannel, block, midiChannel, block, midiChannel, block, midiChannel, block,
+                 i + 1, midiChannel, 0x08 + block, midiChannel, 0x08 + block, midiChannel, 0x08 + block, midiChannel, 0x08 + block);
+        widgets += line;
+
+        snprintf(line, sizeof(line),
+                 "Widget DisplayUpper%d\n\tFB_MCUDisplayUpper %d\nWidgetEnd\n"
+                 "Widget DisplayLower%d\n\tFB_MCUDisplayLower %d\nWidgetEnd\n"
+                 "Widget VUMeter%d\n\tFB_MCUVUMeter %d\nWidgetEnd\n",
+                 i + 1, i % 8, i + 1, i % 8, i + 1, i % 8);
+        widgets += line;
+    }
+
+    widgets += "Widget Shift\n\tPress 90 70 7f 90 70 00\nWidgetEnd\n";
+    widgets += "Widget Option\n\tPress 90 71 7f 90 71 00\nWidgetEnd\n";
+    widgets += "Widget Play\n\tPress 90 72 7f 90 72 00\n\tFB_TwoState 90 72 7f 90 72 00\nWidgetEnd\n";
+    widgets += "Widget Stop\n\tPress 90 73 7f 90 73 00\n\tFB_TwoState 90 73 7f 90 73 00\nWidgetEnd\n";
+
+    WriteFile(csiFolder + "/Surfaces/Midi/Synthetic.mst", widgets);
+
+    string zoneFolder = csiFolder + "/Zones/Synthetic/";
+
+    WriteFile(zoneFolder + "Home.zon",
+              "Zone Home\n"
+              "\tIncludedZones\n\t\tButtons\n\t\tChannel\n\tIncludedZonesEnd\n"
+              "ZoneEnd\n");
+
+    WriteFile(zoneFolder + "Buttons.zon",
+              "Zone Buttons\n"
+              "\tShift\t\tShift\n"
+              "\tOption\t\tOption\n"
+              "\tPlay\t\tPlay\n"
+              "\tStop\t\tStop\n"
+              "\tShift+Play\tRecord\n"
+              "ZoneEnd\n");
+
+    WriteFile(zoneFolder + "Channel.zon",
+              "Zone Channel\n"
+              "\tTrackNavigator\n"
+              "\tDisplayUpper|\t\t\tTrackNameDisplay\n"
+              "\tDisplayLower|\t\t\tTrackPanDisplay\n"
+              "\tFader|Touch+DisplayLower|\tTrackVolumeDisplay\n"
+              "\tVUMeter|\t\t\tTrackOutputMeterAverageLR\n"
+              "\tRotary|\t\t\t\tTrackPan \"0\"\n"
+              "\tShift+Rotary|\t\t\tTrackPanWidth \"1\"\n"
+              "\tMute|\t\t\t\tTrackMute\n"
+              "\tShift+Mute|\t\t\tTrackSolo\n"
+              "\tSelect|\t\t\t\tTrackUniqueSelect\n"
+              "\tOption+Select|\t\t\tTrackRecordArm\n"
+              "\tFader|\t\t\t\tTrackVolume\n"
+              "ZoneEnd\n");
+}
+
+void StartManager()
+{
+    TheManager = new Manager(nullptr);
+    TheManager->Init();
+
+    // Surfaces come online one per frame, once the workers have read their files
+    for(int i = 0; i < 5000 && ( ! GetSyntheticSurface() || ! GetSyntheticSurface()->GetIsOnline()); i++)
+    {
+        TheManager->Run();
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+}
+
+void StopManager()
+{
+    TheManager->Shutdown();
+    delete TheManager;
+    TheManager = nullptr;
+}
+
+Midi_ControlSurface* GetSyntheticSurface()
+{
+    Page* page = TheManager->GetCurrentPage();
+
+    if(page == nullptr || page->GetSurfaces().size() == 0)
+        return nullptr;
+
+    return dynamic_cast<Midi_ControlSurface*>(page->GetSurfaces()[0]);
+}
@@ -0,0 +1,46 @@
+//
+//  daw_stubs.h
+//  reaper_csurf_integrator
+//
+//  A REAPER stand-in so the integrator can be driven outside the host, with synthetic surfaces and zones
+//
+
+#ifndef daw_stubs_h
+#define daw_stubs_h
+
+#include "../control_surface_integrator.h"
+
+struct FakeDAWStats
+{
+    unsigned long long numMidiMessagesSent = 0;
+    unsigned long long numMidiBytesSent = 0;
+};
+
+// Points every REAPER and SWELL entry point the integrator uses at the fakes, numTracks tracks are visible
+void InstallFakeDAW(const string &resourcePath, int numTracks);
+
+// What the [CSI] section of reaper.ini would hold
+void SetFakeCSIOption(const string &key, const string &value);
+
+// Moves the fake track meters, once per simulated frame
+void AdvanceFakeDAWFrame();
+
+// Moves the millisecond clock modifiers and double taps are timed against, without waiting
+void AdvanceFakeDAWClock(double milliseconds);
+
+// Arrives on the synthetic surface's input port with the next read
+void QueueFakeMidiInput(const MIDI_event_ex_t &event);
+
+FakeDAWStats &GetFakeDAWStats();
+
+// Writes CSI/CSI.ini, an MCU style .mst and a Home/Channel/Buttons zone set for one surface of numChannels channels
+void WriteSyntheticFixtures(const string &resourcePath, int numChannels);
+
+// Builds TheManager from the fixtures and runs it until every surface is online
+void StartManager();
+void StopManager();
+
+// The synthetic surface, once online
+Midi_ControlSurface* GetSyntheticSurface();
+
+#endif /* daw_stubs_h */
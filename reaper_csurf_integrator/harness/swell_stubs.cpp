@@ -0,0 +1,13 @@
+//
+//  swell_stubs.cpp
+//  reaper_csurf_integrator
+//
+//  The SWELL function pointers REAPER would fill in, daw_stubs.cpp points the ones in use at fakes
+//
+
+#define SWELL_API_DEFPARM(x)
+#define SWELL_API_DEFINE(ret, func, parms) ret (*func) parms ;
+
+extern "C" {
+#include "../WDL/swell/swell.h"
+};
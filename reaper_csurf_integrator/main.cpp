@@ -44,10 +44,38 @@ gaccel_register_t acreg_write_FX_params =
 
 int g_registered_command_toggle_write_FX_params = 0;
 
+gaccel_register_t acreg_capture_trace =
+{
+    {FCONTROL|FALT|FVIRTKEY, '5', 0},
+    "CSI Toggle Performance Trace Capture to /CSI/CSI_trace.json"
+};
+
+int g_registered_command_toggle_capture_trace = 0;
+
+gaccel_register_t acreg_write_stats =
+{
+    {FCONTROL|FALT|FVIRTKEY, '6', 0},
+    "CSI Write Statistics Snapshot to /CSI/CSI_stats.json"
+};
+
+int g_registered_command_write_stats = 0;
+
+gaccel_register_t acreg_run_benchmarks =
+{
+    {FCONTROL|FALT|FVIRTKEY, '7', 0},
+    "CSI Run Hot Path Benchmarks to /CSI/CSI_benchmark.json"
+};
+
+int g_registered_command_run_benchmarks = 0;
+
 
 extern bool hookCommandProc(int command, int flag);
 
 extern  void ShutdownMidiIO();
+extern  void ShutdownOSCIO();
+extern  void ShutdownFileParsing();
+extern  void ShutdownTraceLog();
+extern  void ShutdownFeedbackWorkers();
 
 extern reaper_csurf_reg_t csurf_integrator_reg;
 
@@ -63,7 +91,11 @@ REAPER_PLUGIN_DLL_EXPORT int REAPER_PLUGIN_ENTRYPOINT(REAPER_PLUGIN_HINSTANCE hI
     
     if (! reaper_plugin_info)
     {
+        ShutdownFeedbackWorkers();
         ShutdownMidiIO();
+        ShutdownOSCIO();
+        ShutdownFileParsing();
+        ShutdownTraceLog();
         return 0;
     }
     
@@ -121,6 +153,27 @@ REAPER_PLUGIN_DLL_EXPORT int REAPER_PLUGIN_ENTRYPOINT(REAPER_PLUGIN_HINSTANCE hI
         
         reaper_plugin_info->Register("gaccel", &acreg_write_FX_params);
         
+        acreg_capture_trace.accel.cmd = g_registered_command_toggle_capture_trace = reaper_plugin_info->Register("command_id", (void*)"CSI Toggle Performance Trace Capture to /CSI/CSI_trace.json");
+        
+        if (!g_registered_command_toggle_capture_trace)
+            return 0; // failed getting a command id, fail!
+        
+        reaper_plugin_info->Register("gaccel", &acreg_capture_trace);
+        
+        acreg_write_stats.accel.cmd = g_registered_command_write_stats = reaper_plugin_info->Register("command_id", (void*)"CSI Write Statistics Snapshot to /CSI/CSI_stats.json");
+        
+        if (!g_registered_command_write_stats)
+            return 0; // failed getting a command id, fail!
+        
+        reaper_plugin_info->Register("gaccel", &acreg_write_stats);
+        
+        acreg_run_benchmarks.accel.cmd = g_registered_command_run_benchmarks = reaper_plugin_info->Register("command_id", (void*)"CSI Run Hot Path Benchmarks to /CSI/CSI_benchmark.json");
+        
+        if (!g_registered_command_run_benchmarks)
+            return 0; // failed getting a command id, fail!
+        
+        reaper_plugin_info->Register("gaccel", &acreg_run_benchmarks);
+        
 
         reaper_plugin_info->Register("hookcommand", (void*)hookCommandProc);
         
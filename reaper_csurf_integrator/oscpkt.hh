@@ -99,7 +99,8 @@ enum {
   TYPE_TAG_FLOAT = 'f',
   TYPE_TAG_DOUBLE = 'd',
   TYPE_TAG_STRING = 's',
-  TYPE_TAG_BLOB = 'b'
+  TYPE_TAG_BLOB = 'b',
+  TYPE_TAG_RGBA = 'r'
 };
 
 /* a few utility functions follow.. */
@@ -399,6 +400,7 @@ public:
   Message &pushInt64(int64_t h) { return pushPod(TYPE_TAG_INT64, h); }
   Message &pushFloat(float f) { return pushPod(TYPE_TAG_FLOAT, f); }
   Message &pushDouble(double d) { return pushPod(TYPE_TAG_DOUBLE, d); }
+  Message &pushRgba(uint32_t c) { return pushPod(TYPE_TAG_RGBA, c); }
   Message &pushStr(const std::string &s) {
     assert(s.size() < 2147483647); // insane values are not welcome
     type_tags += TYPE_TAG_STRING;
@@ -445,7 +447,8 @@ private:
       case TYPE_TAG_TRUE:
       case TYPE_TAG_FALSE: sz = 0; break;
       case TYPE_TAG_INT32: 
-      case TYPE_TAG_FLOAT: sz = 4; break;
+      case TYPE_TAG_FLOAT:
+      case TYPE_TAG_RGBA: sz = 4; break;
       case TYPE_TAG_INT64: 
       case TYPE_TAG_DOUBLE: sz = 8; break;
       case TYPE_TAG_STRING: {
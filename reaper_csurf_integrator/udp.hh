@@ -194,6 +194,11 @@ struct UdpSocket {
     return openSocket("", port, options);
   }
 
+  /** same, but only on one local address, e.g. "127.0.0.1" to stay off the network */
+  bool bindTo(const std::string &host, int port, int options = OPTION_DEFAULT) {
+    return openSocket(host, port, options, true);
+  }
+
   /** open the socket, and prepare for sending datagrams to the specified host:port */
   bool connectTo(const std::string &host, const std::string &port, int options = OPTION_DEFAULT) {
     return openSocket(host, port, options);
@@ -309,18 +314,18 @@ struct UdpSocket {
   }
 
 private:
-  bool openSocket(const std::string &hostname, int port, int options) {
+  bool openSocket(const std::string &hostname, int port, int options, bool binding = false) {
     char port_string[64]; 
 #ifdef _MSC_VER
     _snprintf_s(port_string, 64, 64, "%d", port);
 #else
     snprintf(port_string, 64, "%d", port);
 #endif
-    return openSocket(hostname, port_string, options);    
+    return openSocket(hostname, port_string, options, binding);    
   }
 
-  bool openSocket(const std::string &hostname, const std::string &port, int options) {
-    bool binding = hostname.empty();
+  bool openSocket(const std::string &hostname, const std::string &port, int options, bool binding = false) {
+    binding = binding || hostname.empty();
     close(); error_message.clear();
 
     struct addrinfo hints;
@@ -336,7 +341,7 @@ private:
     int err = 0;
 
     
-    err = getaddrinfo(binding ? 0 : hostname.c_str(), port.empty() ? 0 : port.c_str(), &hints, &result);
+    err = getaddrinfo(hostname.empty() ? 0 : hostname.c_str(), port.empty() ? 0 : port.c_str(), &hints, &result);
     if (err != 0) {
       setErr(gai_strerror(err));
       return false;